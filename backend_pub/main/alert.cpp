@@ -1,77 +1,54 @@
 #include "alert.h"
 #include "logbuf.h"
+#include <math.h>
 
-static const float kTempHighThresholdC = 30.0f;
-static const int kRainMediumMinPct = 1;    // 0 = sem chuva
-static const int kRainHeavyMinPct = 61;    // >=61% considerado forte
+static alert_engine_t s_engine;
 
-static alert_color_t s_rain_color = ALERT_LED_GREEN;
-static alert_color_t s_temp_color = ALERT_LED_GREEN;
-static rain_alert_t s_rain_level = RAIN_NONE;
-static temp_alert_t s_temp_level = TEMP_LOW;
+// Mensagens do logbuf por nível (armazenamento estático)
+static const char *const kRainLog[ALERT_RULE_MAX_LEVELS] = {"SEM CHUVA", "CHUVA MEDIA", "CHUVA FORTE"};
+static const char *const kTempLog[ALERT_RULE_MAX_LEVELS] = {"TEMPERATURA NORMAL", "TEMPERATURA MEDIA", "TEMPERATURA ALTA"};
 
-rain_alert_t alert_level_rain(int rain_pct)
+void alert_init(const alert_thresholds_t *th)
 {
-    if (rain_pct <= 0) return RAIN_NONE;
-    if (rain_pct >= kRainHeavyMinPct) return RAIN_HEAVY;
-    return RAIN_MEDIUM;
+    alert_thresholds_t t;
+    if (th)
+        t = *th;
+    else
+        alert_thresholds_default(&t);
+    if (!alert_thresholds_sanitize(&t))
+        logbuf_add(LOG_LVL_WARN, "ALERT", "Limiares invalidos; usando padrao");
+    alert_engine_init(&s_engine, &t);
 }
 
-alert_color_t alert_color_for_rain(int rain_pct)
+uint32_t alert_eval_and_log(float temp_c, int rain_pct, int64_t now_ms)
 {
-    switch (alert_level_rain(rain_pct))
-    {
-    case RAIN_NONE:   return ALERT_LED_GREEN;
-    case RAIN_MEDIUM: return ALERT_LED_YELLOW;
-    case RAIN_HEAVY:  return ALERT_LED_RED;
-    default:          return ALERT_LED_OFF;
-    }
-}
+    float in[ALERT_IN_COUNT] = {temp_c, NAN, (float)rain_pct};
+    uint32_t changed = alert_engine_update(&s_engine, in, now_ms);
 
-temp_alert_t alert_level_temp(float temp_c)
-{
-    return (temp_c > kTempHighThresholdC) ? TEMP_HIGH : TEMP_LOW;
-}
-
-alert_color_t alert_color_for_temp(float temp_c)
-{
-    return (alert_level_temp(temp_c) == TEMP_HIGH) ? ALERT_LED_RED : ALERT_LED_GREEN;
+    if (changed & (1u << ALERT_RULE_RAIN))
+        logbuf_add(LOG_LVL_INFO, "ALERT", kRainLog[alert_engine_level(&s_engine, ALERT_RULE_RAIN)]);
+    if (changed & (1u << ALERT_RULE_TEMP))
+        logbuf_add(LOG_LVL_INFO, "ALERT", kTempLog[alert_engine_level(&s_engine, ALERT_RULE_TEMP)]);
+    return changed;
 }
 
-void alert_init(void)
+alert_color_t alert_get_rain_color(void)
 {
-    s_rain_color = ALERT_LED_GREEN;
-    s_temp_color = ALERT_LED_GREEN;
-    s_rain_level = RAIN_NONE;
-    s_temp_level = TEMP_LOW;
-}
-
-void alert_eval_and_log(float temp_c, int rain_pct)
-{
-    rain_alert_t r_new = alert_level_rain(rain_pct);
-    alert_color_t rc_new = alert_color_for_rain(rain_pct);
-    temp_alert_t t_new = alert_level_temp(temp_c);
-    alert_color_t tc_new = alert_color_for_temp(temp_c);
-
-    if (r_new != s_rain_level)
+    switch (alert_engine_level(&s_engine, ALERT_RULE_RAIN))
     {
-        s_rain_level = r_new;
-        s_rain_color = rc_new;
-        const char *lvl = (r_new == RAIN_NONE) ? "SEM CHUVA" : (r_new == RAIN_MEDIUM) ? "CHUVA MEDIA" : "CHUVA FORTE";
-        logbuf_add(LOG_LVL_INFO, "ALERT", lvl);
+    case 0:  return ALERT_LED_GREEN;
+    case 1:  return ALERT_LED_YELLOW;
+    default: return ALERT_LED_RED;
     }
+}
 
-    if (t_new != s_temp_level)
-    {
-        s_temp_level = t_new;
-        s_temp_color = tc_new;
-        const char *lvl = (t_new == TEMP_HIGH) ? "TEMPERATURA ALTA" : "TEMPERATURA BAIXA";
-        logbuf_add(LOG_LVL_INFO, "ALERT", lvl);
-    }
+alert_color_t alert_get_temp_color(void)
+{
+    return alert_engine_level(&s_engine, ALERT_RULE_TEMP) >= 2 ? ALERT_LED_RED : ALERT_LED_GREEN;
 }
 
-alert_color_t alert_get_rain_color(void) { return s_rain_color; }
-alert_color_t alert_get_temp_color(void) { return s_temp_color; }
+const char *alert_get_rain_label(void) { return alert_engine_label(&s_engine, ALERT_RULE_RAIN); }
+const char *alert_get_temp_label(void) { return alert_engine_label(&s_engine, ALERT_RULE_TEMP); }
 
 const char *alert_color_str(alert_color_t c)
 {
@@ -84,25 +61,3 @@ const char *alert_color_str(alert_color_t c)
     default: return "OFF";
     }
 }
-
-const char *alert_rain_str(rain_alert_t a)
-{
-    switch (a)
-    {
-    case RAIN_NONE: return "SEM_CHUVA";
-    case RAIN_MEDIUM: return "CHUVA_MEDIA";
-    case RAIN_HEAVY: return "CHUVA_FORTE";
-    default: return "SEM_CHUVA";
-    }
-}
-
-const char *alert_temp_str(temp_alert_t a)
-{
-    switch (a)
-    {
-    case TEMP_LOW: return "TEMP_BAIXA";
-    case TEMP_HIGH: return "TEMP_ALTA";
-    default: return "TEMP_BAIXA";
-    }
-}
-
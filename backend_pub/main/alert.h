@@ -1,4 +1,6 @@
 #pragma once
+#include <stdint.h>
+#include "alert_rules.h"
 
 typedef enum {
     ALERT_LED_OFF = 0,
@@ -7,33 +9,24 @@ typedef enum {
     ALERT_LED_RED = 3
 } alert_color_t;
 
-typedef enum {
-    RAIN_NONE = 0,
-    RAIN_MEDIUM = 1,
-    RAIN_HEAVY = 2
-} rain_alert_t;
-
-typedef enum {
-    TEMP_LOW = 0,
-    TEMP_HIGH = 1
-} temp_alert_t;
+// Alertas de chuva e temperatura sobre o motor compartilhado
+// (components/alert_rules): histerese e permanência mínima evitam que LEDs
+// e logbuf oscilem com leituras perto dos limiares.
+// LEDs: chuva sem/média/forte = verde/amarelo/vermelho; temperatura alta = vermelho.
 
-// Avaliações de chuva
-rain_alert_t alert_level_rain(int rain_pct);
-alert_color_t alert_color_for_rain(int rain_pct);
+// Monta a tabela de regras com os limiares da configuração
+void alert_init(const alert_thresholds_t *th);
 
-// Avaliações de temperatura (limiar 30°C)
-temp_alert_t alert_level_temp(float temp_c);
-alert_color_t alert_color_for_temp(float temp_c);
+// Avalia uma amostra (NAN = leitura ausente); now_ms = instante da captura.
+// Registra no logbuf apenas as mudanças de nível confirmadas e devolve a
+// máscara delas (bit ALERT_RULE_* por regra que mudou; 0 = nada mudou).
+uint32_t alert_eval_and_log(float temp_c, int rain_pct, int64_t now_ms);
 
-// Estado e logging
-void alert_init(void);
-void alert_eval_and_log(float temp_c, int rain_pct);
 alert_color_t alert_get_rain_color(void);
 alert_color_t alert_get_temp_color(void);
 
-// Auxiliares de string
-const char *alert_color_str(alert_color_t c);
-const char *alert_rain_str(rain_alert_t a);
-const char *alert_temp_str(temp_alert_t a);
+// Nível atual ("normal", "chuva_media", ...), igual ao do assinante
+const char *alert_get_rain_label(void);
+const char *alert_get_temp_label(void);
 
+const char *alert_color_str(alert_color_t c);
@@ -2,21 +2,36 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include <string.h>
+#include <math.h>
 
 static app_config_t g_cfg = {};
 static bool g_has_sta = false;
 
+// Valores padrão documentados; valem para chaves ausentes na NVS e para o
+// dispositivo novo (AP), cujo portal exibe e salva o que /api/config devolve
+static void config_defaults(app_config_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->port = 1883;
+    out->batch_size = 1;
+    out->batch_max_s = 60;
+    out->db_temp = 0.3f;
+    out->db_hum = 1.0f;
+    out->db_rain = 2;
+    out->heartbeat_s = 300;
+    alert_thresholds_default(&out->alert);
+}
+
 void config_init() {
     // nvs_flash_init já é chamado no main, mas garantimos aqui
     nvs_flash_init();
-    app_config_t tmp = {};
+    app_config_t tmp;
     g_has_sta = config_load(&tmp);
-    if (g_has_sta) g_cfg = tmp;
+    g_cfg = tmp; // também no modo AP: padrões em vez de zeros
 }
 
 bool config_load(app_config_t *out) {
     if (!out) return false;
-    memset(out, 0, sizeof(*out));
+    config_defaults(out);
     nvs_handle_t h;
     esp_err_t err = nvs_open("appcfg", NVS_READONLY, &h);
     if (err != ESP_OK) return false;
@@ -30,8 +45,24 @@ bool config_load(app_config_t *out) {
     int32_t qos=0; nvs_get_i32(h, "qos", &qos); out->qos = qos;
     len = sizeof(out->user); nvs_get_str(h, "user", out->user, &len);
     len = sizeof(out->pass_mqtt); nvs_get_str(h, "pass_mqtt", out->pass_mqtt, &len);
+    int32_t batch=out->batch_size; nvs_get_i32(h, "batch", &batch); out->batch_size = batch;
+    int32_t batch_s=out->batch_max_s; nvs_get_i32(h, "batch_s", &batch_s); out->batch_max_s = batch_s;
+    int32_t fmt=0; nvs_get_i32(h, "fmt", &fmt); out->payload_fmt = fmt;
+    int32_t rbe=0; nvs_get_i32(h, "rbe", &rbe); out->rbe_enabled = rbe;
+    int32_t db_t=lroundf(out->db_temp * 100.0f); nvs_get_i32(h, "db_temp", &db_t); out->db_temp = db_t / 100.0f; // centésimos
+    int32_t db_h=lroundf(out->db_hum * 100.0f); nvs_get_i32(h, "db_hum", &db_h); out->db_hum = db_h / 100.0f;
+    int32_t db_r=out->db_rain; nvs_get_i32(h, "db_rain", &db_r); out->db_rain = db_r;
+    int32_t hb=out->heartbeat_s; nvs_get_i32(h, "hb_s", &hb); out->heartbeat_s = hb;
+    // Limiares de alerta em centésimos
+    int32_t al_t1 = lroundf(out->alert.temp_mid * 100.0f); nvs_get_i32(h, "al_t1", &al_t1); out->alert.temp_mid = al_t1 / 100.0f;
+    int32_t al_t2 = lroundf(out->alert.temp_high * 100.0f); nvs_get_i32(h, "al_t2", &al_t2); out->alert.temp_high = al_t2 / 100.0f;
+    int32_t al_r1 = lroundf(out->alert.rain_mid * 100.0f); nvs_get_i32(h, "al_r1", &al_r1); out->alert.rain_mid = al_r1 / 100.0f;
+    int32_t al_r2 = lroundf(out->alert.rain_heavy * 100.0f); nvs_get_i32(h, "al_r2", &al_r2); out->alert.rain_heavy = al_r2 / 100.0f;
 
     nvs_close(h);
+    // Limiares inválidos já gravados (ex.: 0/0/0/0 do portal antigo) voltam
+    // ao padrão aqui, para /api/config mostrar os valores em uso
+    alert_thresholds_sanitize(&out->alert);
 
     bool has_sta = out->ssid[0] != '\0' && out->pass[0] != '\0';
     return has_sta;
@@ -50,6 +81,18 @@ bool config_save(const app_config_t *cfg) {
     nvs_set_i32(h, "qos", cfg->qos);
     nvs_set_str(h, "user", cfg->user);
     nvs_set_str(h, "pass_mqtt", cfg->pass_mqtt);
+    nvs_set_i32(h, "batch", cfg->batch_size);
+    nvs_set_i32(h, "batch_s", cfg->batch_max_s);
+    nvs_set_i32(h, "fmt", cfg->payload_fmt);
+    nvs_set_i32(h, "rbe", cfg->rbe_enabled);
+    nvs_set_i32(h, "db_temp", (int32_t)lroundf(cfg->db_temp * 100.0f));
+    nvs_set_i32(h, "db_hum", (int32_t)lroundf(cfg->db_hum * 100.0f));
+    nvs_set_i32(h, "db_rain", cfg->db_rain);
+    nvs_set_i32(h, "hb_s", cfg->heartbeat_s);
+    nvs_set_i32(h, "al_t1", (int32_t)lroundf(cfg->alert.temp_mid * 100.0f));
+    nvs_set_i32(h, "al_t2", (int32_t)lroundf(cfg->alert.temp_high * 100.0f));
+    nvs_set_i32(h, "al_r1", (int32_t)lroundf(cfg->alert.rain_mid * 100.0f));
+    nvs_set_i32(h, "al_r2", (int32_t)lroundf(cfg->alert.rain_heavy * 100.0f));
     err = nvs_commit(h);
     nvs_close(h);
     if (err == ESP_OK) { g_cfg = *cfg; g_has_sta = cfg->ssid[0] && cfg->pass[0]; }
@@ -63,7 +106,7 @@ bool config_clear() {
     nvs_erase_all(h);
     err = nvs_commit(h);
     nvs_close(h);
-    memset(&g_cfg, 0, sizeof(g_cfg));
+    config_defaults(&g_cfg);
     g_has_sta = false;
     return err == ESP_OK;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include "alert_rules.h"
 
 typedef struct {
     char ssid[32];
@@ -10,6 +11,15 @@ typedef struct {
     int  qos;
     char user[64];
     char pass_mqtt[64];
+    int  batch_size;  // amostras por mensagem (<= 1 desativa o lote)
+    int  batch_max_s; // espera máxima para fechar um lote
+    int  payload_fmt; // payload_fmt_t: 0 = JSON (padrão), 1 = binário compacto
+    int  rbe_enabled; // publicação por exceção (banda morta + heartbeat)
+    float db_temp;    // banda morta de temperatura (°C)
+    float db_hum;     // banda morta de umidade (%RH)
+    int  db_rain;     // banda morta de chuva (%)
+    int  heartbeat_s; // silêncio máximo antes de publicar mesmo sem mudança
+    alert_thresholds_t alert; // limiares dos alertas (°C e % de chuva)
 } app_config_t;
 
 // Inicializa NVS e carrega configuração salva (se houver)
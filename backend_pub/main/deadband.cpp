@@ -0,0 +1,74 @@
+#include "deadband.h"
+#include <math.h>
+#include <stdlib.h>
+#include <atomic>
+
+static bool s_enabled = false;
+static float s_db_temp = 0.3f;
+static float s_db_hum = 1.0f;
+static int s_db_rain = 2;
+static int64_t s_heartbeat_us = 300LL * 1000000LL;
+
+static bool s_has_ref = false;
+static sample_t s_ref = {};
+
+static std::atomic<uint32_t> s_evaluated{0};
+static std::atomic<uint32_t> s_published{0};
+static std::atomic<uint32_t> s_suppressed{0};
+static std::atomic<uint32_t> s_heartbeats{0};
+
+void deadband_init(const app_config_t *cfg)
+{
+    s_enabled = cfg->rbe_enabled != 0;
+    s_db_temp = cfg->db_temp;
+    s_db_hum = cfg->db_hum;
+    s_db_rain = cfg->db_rain;
+    s_heartbeat_us = (int64_t)(cfg->heartbeat_s > 0 ? cfg->heartbeat_s : 300) * 1000000LL;
+    s_has_ref = false;
+}
+
+// Mudança de validade (NaN <-> número) sempre conta como mudança
+static bool crossed(float ref, float now, float band)
+{
+    if (isnan(ref) || isnan(now))
+        return isnan(ref) != isnan(now);
+    return fabsf(now - ref) >= band;
+}
+
+bool deadband_should_publish(const sample_t *s, bool alert_changed)
+{
+    s_evaluated.fetch_add(1, std::memory_order_relaxed);
+
+    bool publish = !s_enabled || !s_has_ref || alert_changed ||
+                   crossed(s_ref.temp, s->temp, s_db_temp) ||
+                   crossed(s_ref.hum, s->hum, s_db_hum) ||
+                   abs(s->rain_pct - s_ref.rain_pct) >= s_db_rain;
+
+    if (!publish && s->ts_us - s_ref.ts_us >= s_heartbeat_us)
+    {
+        publish = true;
+        s_heartbeats.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!publish)
+    {
+        s_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    s_ref = *s;
+    s_has_ref = true;
+    s_published.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+deadband_stats_t deadband_get_stats(void)
+{
+    deadband_stats_t st = {};
+    st.enabled = s_enabled;
+    st.evaluated = s_evaluated.load(std::memory_order_relaxed);
+    st.published = s_published.load(std::memory_order_relaxed);
+    st.suppressed = s_suppressed.load(std::memory_order_relaxed);
+    st.heartbeats = s_heartbeats.load(std::memory_order_relaxed);
+    return st;
+}
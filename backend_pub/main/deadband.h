@@ -0,0 +1,28 @@
+#ifndef DEADBAND_H
+#define DEADBAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sampler.h"
+#include "config.h"
+
+// Publicação por exceção: uma amostra só segue para o MQTT quando algum
+// campo sai da banda morta em relação à última publicada, quando um nível
+// de alerta muda ou quando o heartbeat (silêncio máximo) expira.
+
+typedef struct {
+    bool enabled;
+    uint32_t evaluated;  // amostras avaliadas
+    uint32_t published;  // amostras liberadas para publicação
+    uint32_t suppressed; // amostras retidas pela banda morta
+    uint32_t heartbeats; // liberadas apenas pelo heartbeat
+} deadband_stats_t;
+
+void deadband_init(const app_config_t *cfg);
+
+// Decide se 's' deve ser publicada; ao liberar, ela passa a ser a referência
+bool deadband_should_publish(const sample_t *s, bool alert_changed);
+
+deadband_stats_t deadband_get_stats(void);
+
+#endif // DEADBAND_H
@@ -0,0 +1,184 @@
+#include "history.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <math.h>
+
+static_assert(sizeof(history_raw_t) == 8, "history_raw_t deve ter 8 bytes");
+static_assert(sizeof(history_rollup_t) == 16, "history_rollup_t deve ter 16 bytes");
+static_assert(HISTORY_RAW_LEN * sizeof(history_raw_t) +
+                      (HISTORY_1M_LEN + HISTORY_1H_LEN) * sizeof(history_rollup_t) <= 10 * 1024,
+              "historico excede o orcamento de RAM");
+
+// Anel com contador absoluto: a entrada k fica em k % len enquanto
+// k >= total - len, o que dá cursores estáveis para leitores concorrentes.
+typedef struct {
+    void *buf;
+    size_t elem;
+    uint32_t len;
+    uint32_t total;
+} ring_t;
+
+// Acumulador do intervalo corrente (min/max/soma)
+typedef struct {
+    bool active;
+    uint32_t start_s;
+    int16_t t_min, t_max;
+    int32_t t_sum;
+    uint16_t t_n;
+    uint8_t h_min, h_max;
+    uint32_t h_sum;
+    uint16_t h_n;
+    uint8_t r_min, r_max;
+    uint32_t r_sum;
+    uint16_t n;
+} acc_t;
+
+static history_raw_t s_raw[HISTORY_RAW_LEN];
+static history_rollup_t s_1m[HISTORY_1M_LEN];
+static history_rollup_t s_1h[HISTORY_1H_LEN];
+
+static ring_t s_rings[3] = {
+    {s_raw, sizeof(history_raw_t), HISTORY_RAW_LEN, 0},
+    {s_1m, sizeof(history_rollup_t), HISTORY_1M_LEN, 0},
+    {s_1h, sizeof(history_rollup_t), HISTORY_1H_LEN, 0},
+};
+
+static acc_t s_acc_1m = {};
+static acc_t s_acc_1h = {};
+static SemaphoreHandle_t s_lock = nullptr;
+
+static uint32_t ring_ts(const ring_t *r, uint32_t k)
+{
+    // ts_s é o primeiro campo de ambos os tipos de registro
+    uint32_t ts;
+    memcpy(&ts, (const uint8_t *)r->buf + (size_t)(k % r->len) * r->elem, sizeof(ts));
+    return ts;
+}
+
+static void ring_push(ring_t *r, const void *e)
+{
+    memcpy((uint8_t *)r->buf + (size_t)(r->total % r->len) * r->elem, e, r->elem);
+    r->total++;
+}
+
+static void acc_add(acc_t *a, uint32_t bucket_s, int16_t t, uint8_t h, uint8_t rain)
+{
+    if (!a->active)
+    {
+        memset(a, 0, sizeof(*a));
+        a->active = true;
+        a->start_s = bucket_s;
+        a->t_min = INT16_MAX;
+        a->t_max = INT16_MIN;
+        a->h_min = 0xFF;
+        a->r_min = 0xFF;
+    }
+    if (t != HISTORY_TEMP_NONE)
+    {
+        if (t < a->t_min) a->t_min = t;
+        if (t > a->t_max) a->t_max = t;
+        a->t_sum += t;
+        a->t_n++;
+    }
+    if (h != HISTORY_PCT_NONE)
+    {
+        if (h < a->h_min) a->h_min = h;
+        if (h > a->h_max) a->h_max = h;
+        a->h_sum += h;
+        a->h_n++;
+    }
+    if (rain < a->r_min) a->r_min = rain;
+    if (rain > a->r_max) a->r_max = rain;
+    a->r_sum += rain;
+    a->n++;
+}
+
+// Agregado do acumulador (intervalo fechado ou ainda em andamento)
+static void acc_rollup(const acc_t *a, history_rollup_t *out)
+{
+    history_rollup_t &e = *out;
+    e.ts_s = a->start_s;
+    e.t_min = a->t_n ? a->t_min : HISTORY_TEMP_NONE;
+    e.t_max = a->t_n ? a->t_max : HISTORY_TEMP_NONE;
+    e.t_avg = a->t_n ? (int16_t)(a->t_sum / a->t_n) : HISTORY_TEMP_NONE;
+    e.h_min = a->h_n ? a->h_min : HISTORY_PCT_NONE;
+    e.h_max = a->h_n ? a->h_max : HISTORY_PCT_NONE;
+    e.h_avg = a->h_n ? (uint8_t)(a->h_sum / a->h_n) : HISTORY_PCT_NONE;
+    e.r_min = a->r_min;
+    e.r_max = a->r_max;
+    e.r_avg = (uint8_t)(a->r_sum / a->n);
+}
+
+static void acc_flush(acc_t *a, ring_t *r)
+{
+    if (!a->active)
+        return;
+    history_rollup_t e;
+    acc_rollup(a, &e);
+    ring_push(r, &e);
+    a->active = false;
+}
+
+// Fecha o intervalo corrente se a amostra pertence a um novo e acumula
+static void acc_update(acc_t *a, ring_t *r, uint32_t period_s, uint32_t ts_s, int16_t t, uint8_t h, uint8_t rain)
+{
+    uint32_t bucket = ts_s - (ts_s % period_s);
+    if (a->active && a->start_s != bucket)
+        acc_flush(a, r);
+    acc_add(a, bucket, t, h, rain);
+}
+
+void history_init(void)
+{
+    if (!s_lock)
+        s_lock = xSemaphoreCreateMutex();
+}
+
+void history_add(const sample_t *s)
+{
+    history_raw_t e;
+    e.ts_s = (uint32_t)(s->ts_us / 1000000LL);
+    e.temp = isnan(s->temp) ? HISTORY_TEMP_NONE : (int16_t)lroundf(s->temp * 10.0f);
+    e.hum = isnan(s->hum) ? HISTORY_PCT_NONE : (uint8_t)(s->hum < 0 ? 0 : s->hum > 100 ? 100 : lroundf(s->hum));
+    e.rain = (uint8_t)(s->rain_pct < 0 ? 0 : s->rain_pct > 100 ? 100 : s->rain_pct);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    ring_push(&s_rings[HISTORY_RES_RAW], &e);
+    acc_update(&s_acc_1m, &s_rings[HISTORY_RES_1M], 60, e.ts_s, e.temp, e.hum, e.rain);
+    acc_update(&s_acc_1h, &s_rings[HISTORY_RES_1H], 3600, e.ts_s, e.temp, e.hum, e.rain);
+    xSemaphoreGive(s_lock);
+}
+
+bool history_partial(history_res_t res, history_rollup_t *out)
+{
+    const acc_t *a = res == HISTORY_RES_1M ? &s_acc_1m : res == HISTORY_RES_1H ? &s_acc_1h : nullptr;
+    if (!a || !out)
+        return false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool active = a->active;
+    if (active)
+        acc_rollup(a, out);
+    xSemaphoreGive(s_lock);
+    return active;
+}
+
+int history_read(history_res_t res, uint32_t from_s, uint32_t *cursor, void *out, int max)
+{
+    if ((int)res < 0 || res > HISTORY_RES_1H || !cursor || !out)
+        return 0;
+    ring_t *r = &s_rings[res];
+    int n = 0;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t oldest = r->total > r->len ? r->total - r->len : 0;
+    uint32_t k = *cursor < oldest ? oldest : *cursor;
+    // Pula registros anteriores a 'from' (ordem cronológica)
+    while (k < r->total && ring_ts(r, k) < from_s)
+        k++;
+    for (; k < r->total && n < max; ++k, ++n)
+        memcpy((uint8_t *)out + (size_t)n * r->elem, (const uint8_t *)r->buf + (size_t)(k % r->len) * r->elem, r->elem);
+    *cursor = k;
+    xSemaphoreGive(s_lock);
+    return n;
+}
@@ -0,0 +1,54 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sampler.h"
+
+// Série temporal em memória fixa: amostras brutas da última hora e
+// agregados (min/max/média) de 1 minuto e 1 hora, atualizados em O(1)
+// a cada amostra. Orçamento definido em tempo de compilação.
+
+#define HISTORY_RAW_LEN 720 // 1 h a 5 s
+#define HISTORY_1M_LEN 180  // 3 h de agregados por minuto
+#define HISTORY_1H_LEN 48   // 2 dias de agregados por hora
+
+#define HISTORY_TEMP_NONE INT16_MIN // temperatura ausente (DHT falhou)
+#define HISTORY_PCT_NONE 0xFF       // umidade ausente
+
+typedef enum {
+    HISTORY_RES_RAW = 0,
+    HISTORY_RES_1M = 1,
+    HISTORY_RES_1H = 2
+} history_res_t;
+
+// Ponto bruto: temperatura em décimos de °C, umidade/chuva em % inteiros
+typedef struct __attribute__((packed)) {
+    uint32_t ts_s;
+    int16_t temp;
+    uint8_t hum;
+    uint8_t rain;
+} history_raw_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t ts_s; // início do intervalo
+    int16_t t_min, t_max, t_avg;
+    uint8_t h_min, h_max, h_avg;
+    uint8_t r_min, r_max, r_avg;
+} history_rollup_t;
+
+void history_init(void);
+
+// Registra uma amostra (chamado pela task publicadora)
+void history_add(const sample_t *s);
+
+// Copia até 'max' registros com ts_s >= from_s, a partir do índice
+// cronológico '*cursor' (atualizado). Retorna o número copiado.
+// 'out' aponta para history_raw_t ou history_rollup_t conforme 'res'.
+int history_read(history_res_t res, uint32_t from_s, uint32_t *cursor, void *out, int max);
+
+// Agregado parcial do intervalo ainda em andamento (1m ou 1h), que só entra
+// no anel quando o intervalo fecha. false se não houver amostras nele.
+bool history_partial(history_res_t res, history_rollup_t *out);
+
+#endif // HISTORY_H
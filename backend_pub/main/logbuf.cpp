@@ -1,32 +1,228 @@
 #include "logbuf.h"
 #include "esp_timer.h"
 #include <string.h>
+#include <stdio.h>
+#include <atomic>
 
-log_entry_t g_buf[LOGBUF_MAX];
-uint32_t g_count = 0; // total adicionados (para seq)
-uint32_t g_head = 0;  // próxima posição para escrever
+// Marcador de commit por slot: 2 bits de estado + sequência (30 bits)
+//   0                  vazio
+//   seq                entrada 'seq' publicada
+//   WRITING | seq      produtor 'seq' escrevendo
+//   ABANDONED | seq    um produtor (mais antigo) ainda escreve, e 'seq'
+//                      desistiu do slot: 'seq' está resolvida, sem entrada
+//   SKIP | seq         sem entrada válida; sequências até 'seq' resolvidas
+#define LOGBUF_WRITING 0x80000000u
+#define LOGBUF_ABANDONED 0xC0000000u
+#define LOGBUF_SKIP 0x40000000u
+#define LOGBUF_STATE_MASK 0xC0000000u
+#define LOGBUF_SEQ_MASK 0x3FFFFFFFu
+#define LOGBUF_TAG_NONE 0xFF
+#define LOGBUF_HAS_ARG 0x80 // bit em 'level': registro carrega 'arg'
+
+typedef struct
+{
+    std::atomic<uint32_t> commit;
+    uint32_t ts_ms;
+    const char *msg; // literal; formatado somente na leitura
+    uint8_t tag;     // índice em s_tags
+    uint8_t level;   // log_level_t | LOGBUF_HAS_ARG
+    int16_t arg;
+} log_slot_t;
+
+#if UINTPTR_MAX == 0xFFFFFFFFu
+static_assert(sizeof(log_slot_t) == 16, "registro de log deve ter 16 bytes");
+#endif
+
+static log_slot_t s_slots[LOGBUF_MAX];
+static std::atomic<uint32_t> s_seq{0};       // última sequência reservada
+static std::atomic<uint32_t> s_committed{0}; // cursor: tudo até aqui resolvido
+static std::atomic<void (*)(void)> s_notify{nullptr};
+static std::atomic<void (*)(void)> s_error_hook{nullptr};
+
+// Tabela de tags internadas (somente cresce; ponteiros estáticos)
+static std::atomic<const char *> s_tags[LOGBUF_MAX_TAGS];
 
 void logbuf_init(void)
 {
-    g_count = 0;
-    g_head = 0;
-    memset(g_buf, 0, sizeof(g_buf));
+    for (auto &slot : s_slots)
+    {
+        slot.commit.store(0, std::memory_order_relaxed);
+        slot.ts_ms = 0;
+        slot.msg = nullptr;
+        slot.tag = LOGBUF_TAG_NONE;
+        slot.level = 0;
+        slot.arg = 0;
+    }
+    s_seq.store(0, std::memory_order_release);
+    s_committed.store(0, std::memory_order_release);
+}
+
+// Id da tag: comparação por ponteiro no caso comum, strcmp para o mesmo
+// nome vindo de literais diferentes; insere com CAS quando nova.
+static uint8_t tag_id(const char *tag)
+{
+    for (uint8_t i = 0; i < LOGBUF_MAX_TAGS; ++i)
+    {
+        const char *cur = s_tags[i].load(std::memory_order_acquire);
+        while (!cur)
+        {
+            if (s_tags[i].compare_exchange_weak(cur, tag, std::memory_order_acq_rel, std::memory_order_acquire))
+                return i;
+        }
+        if (cur == tag || strcmp(cur, tag) == 0)
+            return i;
+    }
+    return LOGBUF_TAG_NONE;
+}
+
+// 'seq' já foi publicada, descartada ou superada no seu slot (nenhum
+// produtor ainda vai publicá-la)
+static bool seq_resolved(uint32_t seq)
+{
+    uint32_t c = s_slots[(seq - 1) % LOGBUF_MAX].commit.load(std::memory_order_seq_cst);
+    uint32_t v = c & LOGBUF_SEQ_MASK;
+    if ((c & LOGBUF_STATE_MASK) == LOGBUF_WRITING)
+        return v > seq; // escrevendo 'seq' (ou anterior a ela): pendente
+    return c != 0 && v >= seq;
+}
+
+// Avança o cursor sobre as sequências resolvidas, em O(1) amortizado.
+// Chamado por produtores e leitores; a ordem seq_cst garante que um
+// commit concorrente com um avanço seja visto por pelo menos um dos dois.
+static uint32_t advance_committed(void)
+{
+    uint32_t c = s_committed.load(std::memory_order_seq_cst);
+    for (;;)
+    {
+        uint32_t next = c + 1;
+        if (next > s_seq.load(std::memory_order_seq_cst) || !seq_resolved(next))
+            return c;
+        if (s_committed.compare_exchange_weak(c, next, std::memory_order_seq_cst))
+            c = next;
+    }
+}
+
+static void logbuf_put(log_level_t lvl, const char *tag, const char *msg, bool has_arg, int16_t arg)
+{
+    uint32_t seq = (s_seq.fetch_add(1, std::memory_order_seq_cst) + 1) & LOGBUF_SEQ_MASK;
+    log_slot_t *slot = &s_slots[(seq - 1) % LOGBUF_MAX];
+
+    // Toma posse do slot. Se outro produtor ainda escreve nele (buffer deu
+    // a volta durante a escrita), marca a própria sequência como abandonada
+    // em vez de esperar: não há espera ativa entre tasks de prioridades
+    // diferentes, e o cursor de commit não fica preso nela.
+    uint32_t cur = slot->commit.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint32_t state = cur & LOGBUF_STATE_MASK;
+        if ((cur & LOGBUF_SEQ_MASK) >= seq && cur != 0)
+            return; // slot já tem algo mais novo
+        if (state == LOGBUF_WRITING || state == LOGBUF_ABANDONED)
+        {
+            if (slot->commit.compare_exchange_weak(cur, LOGBUF_ABANDONED | seq, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed))
+            {
+                advance_committed();
+                return;
+            }
+            continue;
+        }
+        if (slot->commit.compare_exchange_weak(cur, LOGBUF_WRITING | seq, std::memory_order_acquire,
+                                               std::memory_order_relaxed))
+            break;
+    }
+
+    slot->ts_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
+    slot->msg = msg;
+    slot->tag = tag ? tag_id(tag) : LOGBUF_TAG_NONE;
+    slot->level = (uint8_t)lvl | (has_arg ? LOGBUF_HAS_ARG : 0);
+    slot->arg = arg;
+
+    // Publica: leitores que virem 'seq' enxergam a entrada completa. Se uma
+    // sequência mais nova abandonou o slot enquanto escrevíamos, esta
+    // entrada já saiu da janela: o slot fica só como "resolvido"
+    uint32_t expect = LOGBUF_WRITING | seq;
+    if (!slot->commit.compare_exchange_strong(expect, seq, std::memory_order_seq_cst))
+    {
+        while (!slot->commit.compare_exchange_weak(expect, LOGBUF_SKIP | (expect & LOGBUF_SEQ_MASK),
+                                                   std::memory_order_seq_cst))
+        {
+        }
+    }
+    advance_committed();
+
+    void (*notify)(void) = s_notify.load(std::memory_order_acquire);
+    if (notify)
+        notify();
+    if (lvl == LOG_LVL_ERROR)
+    {
+        void (*hook)(void) = s_error_hook.load(std::memory_order_acquire);
+        if (hook)
+            hook();
+    }
+}
+
+void logbuf_set_notify(void (*fn)(void))
+{
+    s_notify.store(fn, std::memory_order_release);
+}
+
+void logbuf_set_error_hook(void (*fn)(void))
+{
+    s_error_hook.store(fn, std::memory_order_release);
 }
 
 void logbuf_add(log_level_t lvl, const char *tag, const char *msg)
 {
-    log_entry_t e;
-    e.seq = ++g_count;
-    e.ts_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
-    e.level = lvl;
-    // Copia segura de tag e msg
-    strncpy(e.tag, tag ? tag : "-", sizeof(e.tag) - 1);
-    e.tag[sizeof(e.tag) - 1] = '\0';
-    strncpy(e.msg, msg ? msg : "-", sizeof(e.msg) - 1);
-    e.msg[sizeof(e.msg) - 1] = '\0';
-
-    g_buf[g_head] = e;
-    g_head = (g_head + 1) % LOGBUF_MAX;
+    logbuf_put(lvl, tag, msg, false, 0);
+}
+
+void logbuf_add_num(log_level_t lvl, const char *tag, const char *fmt, int16_t arg)
+{
+    logbuf_put(lvl, tag, fmt, true, arg);
+}
+
+uint32_t logbuf_last_seq(void)
+{
+    return s_seq.load(std::memory_order_acquire);
+}
+
+uint32_t logbuf_committed_seq(void)
+{
+    // Normalmente os produtores já avançaram o cursor; o leitor só ajuda
+    return advance_committed();
+}
+
+bool logbuf_read(uint32_t seq, log_entry_t *out)
+{
+    if (seq == 0 || !out)
+        return false;
+    const log_slot_t *slot = &s_slots[(seq - 1) % LOGBUF_MAX];
+    if (slot->commit.load(std::memory_order_acquire) != seq)
+        return false;
+    uint32_t ts_ms = slot->ts_ms;
+    const char *msg = slot->msg;
+    uint8_t tag = slot->tag;
+    uint8_t level = slot->level;
+    int16_t arg = slot->arg;
+    // Se o slot foi retomado durante a cópia, ela pode estar rasgada
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->commit.load(std::memory_order_relaxed) != seq)
+        return false;
+
+    // Formatação adiada: só acontece aqui, fora do caminho dos produtores
+    out->seq = seq;
+    out->ts_ms = ts_ms;
+    out->level = (log_level_t)(level & ~LOGBUF_HAS_ARG);
+    const char *t = tag < LOGBUF_MAX_TAGS ? s_tags[tag].load(std::memory_order_acquire) : nullptr;
+    out->tag = t ? t : "-";
+    if (!msg)
+        strlcpy(out->msg, "-", sizeof(out->msg));
+    else if (level & LOGBUF_HAS_ARG)
+        snprintf(out->msg, sizeof(out->msg), msg, (int)arg);
+    else
+        strlcpy(out->msg, msg, sizeof(out->msg));
+    return true;
 }
 
 static const char *lvl_str(log_level_t l)
@@ -44,6 +240,14 @@ static const char *lvl_str(log_level_t l)
     }
 }
 
+int logbuf_entry_json(const log_entry_t *e, char *out, size_t out_size)
+{
+    int n = snprintf(out, out_size,
+                     "{\"seq\":%lu,\"ts_ms\":%lu,\"level\":\"%s\",\"tag\":\"%s\",\"msg\":\"%s\"}",
+                     (unsigned long)e->seq, (unsigned long)e->ts_ms, lvl_str(e->level), e->tag, e->msg);
+    return (n < 0 || (size_t)n >= out_size) ? 0 : n;
+}
+
 int logbuf_to_json(char *out, size_t out_size)
 {
     // Serializa em um array JSON dos últimos registros (ordem cronológica)
@@ -53,21 +257,20 @@ int logbuf_to_json(char *out, size_t out_size)
     size_t written = 0;
     out[written++] = '[';
 
-    // Determina quantos itens válidos existem
-    uint32_t valid = g_count < LOGBUF_MAX ? g_count : LOGBUF_MAX;
-    // Calcula índice do primeiro item cronológico
-    uint32_t start = (g_count >= LOGBUF_MAX) ? g_head : 0;
+    // Janela atual: últimas LOGBUF_MAX sequências reservadas
+    uint32_t last = logbuf_last_seq();
+    uint32_t first = last > LOGBUF_MAX ? last - LOGBUF_MAX + 1 : 1;
+    bool any = false;
 
-    for (uint32_t i = 0; i < valid; ++i)
+    for (uint32_t seq = first; seq <= last && seq != 0; ++seq)
     {
-        uint32_t idx = (start + i) % LOGBUF_MAX;
-        log_entry_t *e = &g_buf[idx];
+        log_entry_t e;
+        if (!logbuf_read(seq, &e))
+            continue;
         char item[256];
-        int n = snprintf(item, sizeof(item),
-                         "{\"seq\":%lu,\"ts_ms\":%lu,\"level\":\"%s\",\"tag\":\"%s\",\"msg\":\"%s\"}",
-                         (unsigned long)e->seq, (unsigned long)e->ts_ms, lvl_str(e->level), e->tag, e->msg);
+        int n = logbuf_entry_json(&e, item, sizeof(item));
         // Adiciona vírgula se não for o primeiro
-        if (i > 0)
+        if (any)
         {
             if (written + 1 >= out_size)
                 break;
@@ -80,6 +283,7 @@ int logbuf_to_json(char *out, size_t out_size)
         }
         memcpy(out + written, item, (size_t)n);
         written += (size_t)n;
+        any = true;
     }
 
     if (written + 1 <= out_size)
@@ -1,8 +1,11 @@
 #pragma once
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 
-#define LOGBUF_MAX 100
+#define LOGBUF_MAX 1024
+#define LOGBUF_MAX_TAGS 32
+#define LOGBUF_MSG_LEN 96
 
 typedef enum
 {
@@ -11,26 +14,61 @@ typedef enum
     LOG_LVL_ERROR = 2
 } log_level_t;
 
+// Entrada já formatada, montada apenas na leitura (ex.: /logs)
 typedef struct
 {
-    uint32_t seq;      // sequência incremental
-    uint32_t ts_ms;    // timestamp relativo em ms (uptime)
-    log_level_t level; // nível
-    char tag[16];      // componente
-    char msg[96];      // mensagem
+    uint32_t seq;              // sequência incremental
+    uint32_t ts_ms;            // timestamp relativo em ms (uptime)
+    log_level_t level;         // nível
+    const char *tag;           // componente
+    char msg[LOGBUF_MSG_LEN];  // mensagem
 } log_entry_t;
 
+// Buffer circular multi-produtor: cada logbuf_add reserva uma sequência
+// com incremento atômico e publica o slot com um marcador de commit.
+// Leitores copiam o slot e conferem o marcador, nunca vendo entradas
+// pela metade; slots em escrita ou já sobrescritos são ignorados. Um
+// produtor que encontra o slot ainda em escrita (o buffer deu a volta)
+// descarta a entrada e a marca como resolvida. Sequências têm 30 bits.
+//
+// Os registros são compactos (16 bytes): guardam o id da tag, o ponteiro
+// da mensagem e um argumento numérico opcional. O texto só é formatado
+// na leitura, portanto 'tag' e 'msg' devem ter armazenamento estático
+// (literais ou 'static const char *TAG').
+
 // Inicializa o buffer (opcional)
 void logbuf_init(void);
 
 // Adiciona uma entrada de log ao buffer
 void logbuf_add(log_level_t lvl, const char *tag, const char *msg);
 
+// Variante com um argumento numérico, formatado por 'fmt' (ex.: "%d") na leitura
+void logbuf_add_num(log_level_t lvl, const char *tag, const char *fmt, int16_t arg);
+
+// Sequência da última entrada reservada (0 = vazio)
+uint32_t logbuf_last_seq(void);
+
+// Maior sequência 'h' tal que todas as entradas até 'h' já foram publicadas
+// ou descartadas (nenhuma escrita em andamento antes dela). Mantido como
+// cursor pelos produtores: O(1) amortizado. Clientes incrementais devem
+// usar este valor como cursor.
+uint32_t logbuf_committed_seq(void);
+
+// Copia a entrada de sequência 'seq' se ainda estiver no buffer e
+// completamente escrita. Retorna false caso contrário.
+bool logbuf_read(uint32_t seq, log_entry_t *out);
+
+// Serializa uma entrada como objeto JSON. Retorna bytes escritos (0 se não coube)
+int logbuf_entry_json(const log_entry_t *e, char *out, size_t out_size);
+
+// Função chamada após cada entrada publicada (ex.: acordar a task SSE).
+// Deve ser curta e não pode chamar logbuf_add.
+void logbuf_set_notify(void (*fn)(void));
+
+// Função chamada após cada entrada LOG_LVL_ERROR publicada (ex.: gravar os
+// logs em flash antes de um possível reset). Mesmas restrições de notify.
+void logbuf_set_error_hook(void (*fn)(void));
+
 // Serializa todas as entradas em JSON (array de objetos)
 // Retorna o número de bytes escritos
 int logbuf_to_json(char *out, size_t out_size);
-
-// Exposição opcional para serialização em chunks
-extern log_entry_t g_buf[LOGBUF_MAX];
-extern uint32_t g_count;
-extern uint32_t g_head;
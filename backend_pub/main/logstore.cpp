@@ -0,0 +1,298 @@
+#include "logstore.h"
+#include "timesync.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "LOGSTORE";
+
+#define LOGSTORE_SECTOR_SIZE 4096
+#define LOGSTORE_REC_LEN 64
+#define LOGSTORE_RECS_PER_SECTOR (LOGSTORE_SECTOR_SIZE / LOGSTORE_REC_LEN)
+#define LOGSTORE_BATCH 16 // registros por gravação
+#define LOGSTORE_PSEQ_ERASED 0xFFFFFFFFu
+#define LOGSTORE_SHUTDOWN_WAIT_MS 200 // espera pelo flush em andamento no restart
+
+typedef struct __attribute__((packed)) {
+    uint32_t pseq;  // sequência persistente (0xFFFFFFFF = slot apagado)
+    uint32_t ts_ms;
+    uint16_t boot;
+    uint8_t level;
+    char tag[LOGSTORE_TAG_LEN]; // sem terminador quando cheio
+    char msg[LOGSTORE_MSG_LEN];
+    uint8_t crc; // CRC-8 dos 63 bytes anteriores
+} logstore_rec_t;
+
+static_assert(sizeof(logstore_rec_t) == LOGSTORE_REC_LEN, "registro deve ter 64 bytes");
+
+static const esp_partition_t *s_part = nullptr;
+static SemaphoreHandle_t s_lock = nullptr;
+static SemaphoreHandle_t s_flush_lock = nullptr; // serializa task e shutdown
+static TaskHandle_t s_task = nullptr;
+static uint32_t s_slots = 0;     // registros na partição
+static uint32_t s_head = 0;      // próximo slot a gravar
+static uint32_t s_next_pseq = 1; // pseq do próximo registro
+static uint32_t s_count = 0;     // slots da janela terminando em s_head - 1
+static uint16_t s_boot = 1;
+static uint32_t s_cursor = 0; // última sequência do logbuf já persistida
+
+static std::atomic<uint32_t> s_recovered{0};
+static std::atomic<uint32_t> s_written{0};
+static std::atomic<uint32_t> s_lost{0};
+
+static uint8_t crc8(const uint8_t *p, size_t n)
+{
+    uint8_t crc = 0;
+    while (n--)
+    {
+        crc ^= *p++;
+        for (int i = 0; i < 8; ++i)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static bool rec_valid(const logstore_rec_t *r)
+{
+    return r->pseq != LOGSTORE_PSEQ_ERASED && r->crc == crc8((const uint8_t *)r, offsetof(logstore_rec_t, crc));
+}
+
+static bool rec_read(uint32_t slot, logstore_rec_t *r)
+{
+    return esp_partition_read(s_part, (size_t)slot * LOGSTORE_REC_LEN, r, sizeof(*r)) == ESP_OK;
+}
+
+static bool rec_erased(const logstore_rec_t *r)
+{
+    const uint8_t *p = (const uint8_t *)r;
+    for (size_t i = 0; i < sizeof(*r); ++i)
+        if (p[i] != 0xFF)
+            return false;
+    return true;
+}
+
+// Grava 'n' registros contíguos a partir de s_head (sem cruzar setor)
+static bool write_batch(logstore_rec_t *recs, int n)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool ok = true;
+    // Entrando em um novo segmento: apaga-o; os registros mais antigos saem da janela
+    if (s_head % LOGSTORE_RECS_PER_SECTOR == 0)
+    {
+        if (s_count > s_slots - LOGSTORE_RECS_PER_SECTOR)
+            s_count = s_slots - LOGSTORE_RECS_PER_SECTOR;
+        ok = esp_partition_erase_range(s_part, (size_t)s_head * LOGSTORE_REC_LEN, LOGSTORE_SECTOR_SIZE) == ESP_OK;
+    }
+    if (ok)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            recs[i].pseq = s_next_pseq + (uint32_t)i;
+            recs[i].crc = crc8((const uint8_t *)&recs[i], offsetof(logstore_rec_t, crc));
+        }
+        ok = esp_partition_write(s_part, (size_t)s_head * LOGSTORE_REC_LEN, recs, (size_t)n * LOGSTORE_REC_LEN) == ESP_OK;
+    }
+    // Mesmo em falha os slots são consumidos: nunca regrava sobre bits já escritos
+    s_head = (s_head + (uint32_t)n) % s_slots;
+    s_next_pseq += (uint32_t)n;
+    s_count = s_count + (uint32_t)n > s_slots ? s_slots : s_count + (uint32_t)n;
+    xSemaphoreGive(s_lock);
+
+    if (ok)
+        s_written.fetch_add((uint32_t)n, std::memory_order_relaxed);
+    else
+        ESP_LOGE(TAG, "Falha ao gravar segmento de log");
+    return ok;
+}
+
+// Copia para a flash as entradas do logbuf publicadas desde o último lote
+static void logstore_flush(void)
+{
+    uint32_t upto = logbuf_committed_seq();
+    uint32_t first = upto > LOGBUF_MAX ? upto - LOGBUF_MAX + 1 : 1;
+    if (s_cursor + 1 < first)
+    {
+        s_lost.fetch_add(first - s_cursor - 1, std::memory_order_relaxed);
+        s_cursor = first - 1;
+    }
+
+    logstore_rec_t batch[LOGSTORE_BATCH];
+    int n = 0;
+    for (uint32_t seq = s_cursor + 1; seq <= upto && seq != 0; ++seq)
+    {
+        log_entry_t e;
+        if (!logbuf_read(seq, &e))
+        {
+            s_lost.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        logstore_rec_t *r = &batch[n++];
+        memset(r, 0, sizeof(*r));
+        r->ts_ms = e.ts_ms;
+        r->boot = s_boot;
+        r->level = (uint8_t)e.level;
+        strncpy(r->tag, e.tag, sizeof(r->tag));
+        strncpy(r->msg, e.msg, sizeof(r->msg));
+
+        // Lote cheio ou fim do segmento atual
+        if (n == LOGSTORE_BATCH || (s_head + (uint32_t)n) % LOGSTORE_RECS_PER_SECTOR == 0)
+        {
+            write_batch(batch, n);
+            n = 0;
+        }
+    }
+    if (n > 0)
+        write_batch(batch, n);
+    s_cursor = upto;
+}
+
+static void logstore_task(void *arg)
+{
+    for (;;)
+    {
+        // Acorda no intervalo ou logo após uma entrada ERROR
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOGSTORE_FLUSH_MS));
+        xSemaphoreTake(s_flush_lock, portMAX_DELAY);
+        logstore_flush();
+        xSemaphoreGive(s_flush_lock);
+    }
+}
+
+// Gancho do logbuf: curto, apenas acorda a task
+static void on_error_logged(void)
+{
+    if (s_task)
+        xTaskNotifyGive(s_task);
+}
+
+// esp_restart: grava o que ainda está só em RAM. Em panic o handler não
+// roda (flash inacessível ali); o flush por ERROR cobre os avisos prévios.
+static void on_shutdown(void)
+{
+    if (xSemaphoreTake(s_flush_lock, pdMS_TO_TICKS(LOGSTORE_SHUTDOWN_WAIT_MS)) != pdTRUE)
+        return;
+    logstore_flush();
+    xSemaphoreGive(s_flush_lock);
+}
+
+bool logstore_init(void)
+{
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)LOGSTORE_PARTITION_SUBTYPE,
+                                      LOGSTORE_PARTITION_LABEL);
+    if (!s_part)
+    {
+        ESP_LOGW(TAG, "Particao '%s' nao encontrada; logs somente em RAM", LOGSTORE_PARTITION_LABEL);
+        return false;
+    }
+    s_slots = (s_part->size / LOGSTORE_SECTOR_SIZE) * LOGSTORE_RECS_PER_SECTOR;
+
+    // 1. Registro mais recente (maior pseq) posiciona a escrita
+    logstore_rec_t r;
+    uint16_t last_boot = 0;
+    uint32_t max_pseq = 0;
+    uint32_t max_slot = 0;
+    bool found = false;
+    for (uint32_t slot = 0; slot < s_slots; ++slot)
+    {
+        if (!rec_read(slot, &r) || !rec_valid(&r))
+            continue;
+        if (!found || r.pseq > max_pseq)
+        {
+            found = true;
+            max_pseq = r.pseq;
+            max_slot = slot;
+            last_boot = r.boot;
+        }
+    }
+    // Mesmo boot id da telemetria; sem NVS, segue a numeração da flash
+    s_boot = timesync_boot_id();
+    if (s_boot == 0)
+        s_boot = (uint16_t)(last_boot + 1);
+
+    if (found)
+    {
+        s_head = (max_slot + 1) % s_slots;
+        s_next_pseq = max_pseq + 1;
+
+        // 2. Janela contígua que termina no registro mais recente
+        uint32_t slot = max_slot;
+        uint32_t expect = max_pseq;
+        while (s_count < s_slots && rec_read(slot, &r) && rec_valid(&r) && r.pseq == expect)
+        {
+            s_count++;
+            expect--;
+            slot = (slot + s_slots - 1) % s_slots;
+        }
+        s_recovered.store(s_count, std::memory_order_relaxed);
+
+        // 3. Gravação interrompida no meio do setor deixa lixo: pula os slots
+        // não apagados (consomem pseq e são ignorados na leitura)
+        while (s_head % LOGSTORE_RECS_PER_SECTOR != 0 && rec_read(s_head, &r) && !rec_erased(&r))
+        {
+            s_head = (s_head + 1) % s_slots;
+            s_next_pseq++;
+            s_count = s_count < s_slots ? s_count + 1 : s_slots;
+        }
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    s_flush_lock = xSemaphoreCreateMutex();
+    xTaskCreate(logstore_task, "logstore", 3072, NULL, tskIDLE_PRIORITY + 1, &s_task);
+    logbuf_set_error_hook(on_error_logged);
+    esp_register_shutdown_handler(on_shutdown);
+
+    ESP_LOGI(TAG, "Boot %u, %lu registros recuperados (capacidade %lu)", (unsigned)s_boot,
+             (unsigned long)s_count, (unsigned long)s_slots);
+    if (s_count > 0)
+        logbuf_add_num(LOG_LVL_INFO, TAG, "%d registros de log recuperados da flash", (int16_t)s_count);
+    return true;
+}
+
+int logstore_read(uint32_t *cursor, logstore_entry_t *out, int max)
+{
+    if (!s_part || !cursor || !out)
+        return 0;
+
+    int n = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t oldest = s_next_pseq - s_count;
+    uint32_t p = *cursor + 1 > oldest ? *cursor + 1 : oldest;
+    for (; p < s_next_pseq && n < max; ++p)
+    {
+        uint32_t slot = (s_head + s_slots - (s_next_pseq - p)) % s_slots;
+        logstore_rec_t r;
+        if (!rec_read(slot, &r) || !rec_valid(&r) || r.pseq != p)
+            continue;
+        logstore_entry_t *e = &out[n++];
+        e->pseq = r.pseq;
+        e->boot = r.boot;
+        e->ts_ms = r.ts_ms;
+        e->level = (log_level_t)r.level;
+        memcpy(e->tag, r.tag, LOGSTORE_TAG_LEN);
+        e->tag[LOGSTORE_TAG_LEN] = '\0';
+        memcpy(e->msg, r.msg, LOGSTORE_MSG_LEN);
+        e->msg[LOGSTORE_MSG_LEN] = '\0';
+    }
+    *cursor = p - 1;
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+logstore_stats_t logstore_get_stats(void)
+{
+    logstore_stats_t st = {};
+    st.enabled = s_part != nullptr;
+    st.boot = s_boot;
+    st.count = s_count;
+    st.capacity = s_slots;
+    st.recovered = s_recovered.load(std::memory_order_relaxed);
+    st.written = s_written.load(std::memory_order_relaxed);
+    st.lost = s_lost.load(std::memory_order_relaxed);
+    return st;
+}
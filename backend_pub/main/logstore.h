@@ -0,0 +1,52 @@
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "logbuf.h"
+
+// Persistência opcional do logbuf na partição "logstore" (ativa se a
+// partição existir). Uma task de baixa prioridade copia as entradas novas
+// do logbuf em lotes para registros de tamanho fixo gravados em modo
+// append circular; cada setor (segmento) só é apagado quando a escrita
+// volta a ele. logbuf_add não é afetado: a task lê pelo cursor de sequência.
+// Além do intervalo fixo, um lote é gravado logo após cada entrada ERROR e
+// no esp_restart (handler de shutdown), preservando as últimas linhas.
+// O boot gravado é o mesmo da telemetria (timesync_boot_id).
+
+#define LOGSTORE_PARTITION_LABEL "logstore"
+#define LOGSTORE_PARTITION_SUBTYPE 0x41
+#define LOGSTORE_FLUSH_MS 5000 // intervalo entre lotes gravados
+#define LOGSTORE_TAG_LEN 8
+#define LOGSTORE_MSG_LEN 44
+
+typedef struct {
+    uint32_t pseq;  // sequência persistente (monotônica entre boots)
+    uint16_t boot;  // boot em que a entrada foi gerada
+    uint32_t ts_ms; // uptime daquele boot
+    log_level_t level;
+    char tag[LOGSTORE_TAG_LEN + 1];
+    char msg[LOGSTORE_MSG_LEN + 1];
+} logstore_entry_t;
+
+typedef struct {
+    bool enabled;
+    uint16_t boot;      // boot atual
+    uint32_t count;     // registros válidos na partição
+    uint32_t capacity;  // registros na partição
+    uint32_t recovered; // registros de boots anteriores encontrados no init
+    uint32_t written;   // registros gravados desde o boot
+    uint32_t lost;      // entradas sobrescritas no logbuf antes do flush
+} logstore_stats_t;
+
+// Localiza a partição, recupera a cauda gravada e inicia a task de flush.
+// Chamar após timesync_init (boot id).
+bool logstore_init(void);
+
+// Copia até 'max' entradas com pseq > '*cursor' (0 = desde a mais antiga),
+// em ordem cronológica, e avança o cursor. Retorna o número copiado.
+int logstore_read(uint32_t *cursor, logstore_entry_t *out, int max);
+
+logstore_stats_t logstore_get_stats(void);
+
+#endif // LOGSTORE_H
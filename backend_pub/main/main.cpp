@@ -13,21 +13,20 @@
 #include <string.h>
 #include <math.h>
 #include "driver/gpio.h"
-
-// --- NOVO: Biblioteca do ADC para o FC-37 ---
-#include "driver/adc.h"
-
-// SENSORES
-#include "dht.h"
+#include "esp_timer.h"
+#include "sampler.h"
+#include "payload.h"
+#include "telemq.h"
+#include "deadband.h"
+#include "history.h"
+#include "logstore.h"
+#include "metrics.h"
+#include "timesync.h"
 
 static const char *TAG = "MQTT_PUB";
 
-// Sensor configuration
-#define DHT_GPIO GPIO_NUM_21
-#define DHT_TYPE DHT_TYPE_DHT11
-
-// GPIO 34 corresponde ao ADC1_CHANNEL_6.
-#define RAIN_ADC_CHANNEL ADC1_CHANNEL_6
+// Período de amostragem dos sensores
+#define SAMPLE_PERIOD_MS 5000
 
 // --- Pinos dos LEDs (preferência solicitada) ---
 #define LED_RAIN_GREEN GPIO_NUM_23
@@ -70,13 +69,186 @@ static void set_temp_led(alert_color_t c)
     gpio_set_level(LED_TEMP_RED, c == ALERT_LED_RED);
 }
 
+typedef struct {
+    esp_mqtt_client_handle_t client;
+    const app_config_t *cfg;
+} publisher_ctx_t;
+
+// Atualiza dashboard, alertas e LEDs com uma amostra recém-retirada da fila.
+// Retorna true se algum nível de alerta mudou.
+static bool apply_sample(const sample_t *s)
+{
+    // Log informativo resumido do ciclo
+    logbuf_add(LOG_LVL_INFO, "SENS", "Leitura sensores concluida");
+
+    // Histórico recebe todas as amostras, inclusive as retidas pela banda morta
+    history_add(s);
+
+    // Atualiza telemetria para Dashboard
+    status_set_telemetry(s->temp, s->hum, s->rain_pct);
+
+    // Avalia alertas e aciona LEDs. A máscara vem do motor: normal <-> média
+    // de temperatura mantém o LED verde, mas também conta como mudança
+    uint32_t changed = alert_eval_and_log(s->temp, s->rain_pct, s->ts_us / 1000);
+    set_rain_led(alert_get_rain_color());
+    set_temp_led(alert_get_temp_color());
+
+    // Dashboards conectados via SSE recebem a leitura imediatamente
+    webserver_push_status();
+
+    return changed != 0;
+}
+
+// Publica 'n' amostras: objeto simples quando o lote está desativado
+// (batch_size <= 1), senão uma única mensagem com todas. No formato binário
+// a mensagem sempre carrega a lista de amostras. Retorna false se a
+// publicação não foi aceita pelo cliente MQTT.
+static bool publish_samples(publisher_ctx_t *ctx, const sample_t *batch, int n, bool replay)
+{
+    const app_config_t *cfg = ctx->cfg;
+    static char payload[2048];
+    bool binary = (cfg->payload_fmt == PAYLOAD_FMT_BINARY);
+    int len;
+    if (binary)
+        len = payload_encode_bin(batch, n, replay, (uint8_t *)payload, sizeof(payload));
+    else if (n == 1 && cfg->batch_size <= 1 && !replay)
+        len = payload_encode_json(&batch[0], payload, sizeof(payload));
+    else
+        len = payload_encode_json_batch(batch, n, replay, payload, sizeof(payload));
+
+    if (len < 0)
+    {
+        ESP_LOGE(TAG, "Erro ao montar payload");
+        logbuf_add(LOG_LVL_ERROR, "MQTT", "Erro ao montar payload");
+        return false;
+    }
+
+    // Publica no tópico de sensores
+    const char *topic = (cfg->topic[0]) ? cfg->topic : "esp/sensors";
+    int qos = (cfg->qos >= 0 && cfg->qos <= 2) ? cfg->qos : 0;
+    int msg_id = mqtt_publish(ctx->client, topic, payload, len, qos, 0);
+    if (msg_id < 0)
+    {
+        metrics_inc(MET_MQTT_PUB_FAIL);
+        return false;
+    }
+    metrics_inc(MET_MQTT_PUB);
+
+    if (binary)
+        ESP_LOGI(TAG, "Payload binario publicado (%d amostra(s), %d bytes)", n, len);
+    else
+        ESP_LOGI(TAG, "Payload publicado (%d amostra(s)): %s", n, payload);
+    if (!replay)
+        logbuf_add(LOG_LVL_INFO, "MQTT", "Payload publicado");
+    return true;
+}
+
+// Publica amostras recém-capturadas. Sem broker (ou se o cliente recusar),
+// grava-as na fila em flash em vez de deixá-las crescer no outbox em RAM.
+static void publish_pending(publisher_ctx_t *ctx, const sample_t *batch, int n)
+{
+    if (ctx->client && mqtt_is_connected() && publish_samples(ctx, batch, n, false))
+        return;
+
+    int stored = 0;
+    for (int i = 0; i < n; ++i)
+        stored += telemq_push(&batch[i]) ? 1 : 0;
+
+    if (stored > 0)
+    {
+        ESP_LOGW(TAG, "Broker indisponivel: %d amostra(s) gravada(s) em flash", stored);
+        logbuf_add(LOG_LVL_WARN, "MQTT", "Broker indisponivel, amostra gravada em flash");
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Falha ao publicar MQTT");
+        logbuf_add(LOG_LVL_ERROR, "MQTT", "Falha ao publicar");
+    }
+}
+
+// Reenvia um lote limitado da fila em flash; o intervalo mínimo entre
+// lotes evita que o backlog dispute banda com as amostras ao vivo.
+static void replay_stored(publisher_ctx_t *ctx)
+{
+    static sample_t replay[TELEMQ_REPLAY_BURST];
+    int n = telemq_peek(replay, TELEMQ_REPLAY_BURST);
+    if (n > 0 && publish_samples(ctx, replay, n, true))
+        telemq_ack(n);
+}
+
+// Consome a fila de amostras: alertas, LEDs, dashboard e publicação MQTT.
+// Uma publicação lenta apenas acumula amostras na fila, sem atrasar a amostragem.
+// Em modo lote, acumula até batch_size amostras ou batch_max_s segundos.
+static void publisher_task(void *arg)
+{
+    publisher_ctx_t *ctx = (publisher_ctx_t *)arg;
+    const app_config_t *cfg = ctx->cfg;
+
+    int batch_size = cfg->batch_size;
+    if (batch_size < 1)
+        batch_size = 1;
+    if (batch_size > PAYLOAD_BATCH_MAX)
+        batch_size = PAYLOAD_BATCH_MAX;
+    int64_t max_wait_us = (int64_t)(cfg->batch_max_s > 0 ? cfg->batch_max_s : 60) * 1000000LL;
+    const int64_t replay_interval_us = (int64_t)TELEMQ_REPLAY_INTERVAL_MS * 1000;
+
+    static sample_t batch[PAYLOAD_BATCH_MAX];
+    int n = 0;
+    int64_t deadline_us = 0;
+    int64_t next_replay_us = 0;
+    uint32_t pub_seq = 0; // só amostras publicadas numeram: lacunas no assinante são perdas
+
+    while (1)
+    {
+        TickType_t wait = portMAX_DELAY;
+        if (n > 0)
+        {
+            int64_t remaining_us = deadline_us - esp_timer_get_time();
+            wait = remaining_us > 0 ? pdMS_TO_TICKS(remaining_us / 1000) : 0;
+        }
+        // Com pendências em flash, acorda periodicamente para reenviar
+        if (telemq_depth() > 0 && wait > pdMS_TO_TICKS(TELEMQ_REPLAY_INTERVAL_MS))
+            wait = pdMS_TO_TICKS(TELEMQ_REPLAY_INTERVAL_MS);
+
+        sample_t s;
+        if (sampler_pop(&s, wait) && deadband_should_publish(&s, apply_sample(&s)))
+        {
+            if (n == 0)
+                deadline_us = esp_timer_get_time() + max_wait_us;
+            s.seq = ++pub_seq;
+            s.boot = timesync_boot_id();
+            s.epoch_ms = timesync_epoch_ms(s.ts_us);
+            batch[n++] = s;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        if (n > 0 && (n >= batch_size || now_us >= deadline_us))
+        {
+            publish_pending(ctx, batch, n);
+            n = 0;
+        }
+
+        if (ctx->client && mqtt_is_connected() && telemq_depth() > 0 && now_us >= next_replay_us)
+        {
+            replay_stored(ctx);
+            next_replay_us = now_us + replay_interval_us;
+        }
+    }
+}
+
 extern "C" void app_main(void)
 {
     logbuf_init();
     nvs_flash_init();
+    // Contador de boots, compartilhado pela telemetria e pelos logs em flash
+    timesync_init();
+    // Persistência dos logs em flash (recupera a cauda do boot anterior)
+    logstore_init();
     logbuf_add(LOG_LVL_INFO, "SYS", "NVS inicializado");
     wifi_init();
     logbuf_add(LOG_LVL_INFO, "SYS", "Wi-Fi inicializado");
+    // Estado de rede em cache, atualizado por eventos (consultado por /status)
+    status_init();
 
     // Configuração: AP para setup se não houver STA, senão inicia STA
     config_init();
@@ -86,6 +258,8 @@ extern "C" void app_main(void)
         wifi_start_sta(cfg->ssid, cfg->pass);
         // Aguarda IP antes de iniciar serviços
         xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
+        // Relógio de parede para carimbar as amostras (latência no assinante)
+        timesync_start();
     }
     else
     {
@@ -94,6 +268,9 @@ extern "C" void app_main(void)
         logbuf_add(LOG_LVL_INFO, "WIFI", "Modo AP para configuracao");
     }
 
+    // Histórico em RAM (consultado pelo endpoint /history)
+    history_init();
+
     // Inicia WebServer
     webserver_start();
     logbuf_add(LOG_LVL_INFO, "WEB", "Webserver iniciado");
@@ -101,17 +278,10 @@ extern "C" void app_main(void)
     ESP_LOGI(TAG, "Acesse: http://%s/", ip);
     logbuf_add(LOG_LVL_INFO, "WEB", "Acesse via HTTP");
 
-    // Inicializa alertas e LEDs
-    alert_init();
+    // Inicializa alertas (limiares da configuração) e LEDs
+    alert_init(&cfg->alert);
     leds_init();
 
-    // --- NOVO: Inicializa ADC para Sensor de Chuva ---
-    // Configura resolução de 12 bits (0 a 4095)
-    adc1_config_width(ADC_WIDTH_BIT_12);
-    // Configura atenuação para ler a faixa completa de 0 a ~3.3V
-    adc1_config_channel_atten(RAIN_ADC_CHANNEL, ADC_ATTEN_DB_11);
-    logbuf_add(LOG_LVL_INFO, "ADC", "ADC FC-37 configurado");
-
     // Inicia MQTT somente se conectado e broker configurado
     esp_mqtt_client_handle_t client = nullptr;
     if (wifi_is_connected() && cfg->broker[0])
@@ -122,71 +292,17 @@ extern "C" void app_main(void)
         logbuf_add(LOG_LVL_INFO, "MQTT", "Cliente MQTT iniciado");
     }
 
-    while (1)
-    {
-        vTaskDelay(pdMS_TO_TICKS(5000));
-
-        // 1. Leitura DHT
-        float dht_temp = NAN, dht_hum = NAN;
-        esp_err_t dht_res = dht_read_float_data(DHT_TYPE, DHT_GPIO, &dht_hum, &dht_temp);
-        if (dht_res != ESP_OK)
-        {
-            ESP_LOGW(TAG, "Falha ao ler DHT: %d", (int)dht_res);
-            logbuf_add(LOG_LVL_WARN, "DHT", "Falha ao ler DHT");
-        }
-
-        // 2. --- NOVO: Leitura FC-37 ---
-        int rain_raw = adc1_get_raw(RAIN_ADC_CHANNEL);
-
-        // Vamos converter para % de umidade (0% = seco, 100% = chuva forte)
-        int rain_percent = 100 - ((rain_raw * 100) / 4095);
-
-        // Clamp para garantir limites entre 0 e 100
-        if (rain_percent < 0)
-            rain_percent = 0;
-        if (rain_percent > 100)
-            rain_percent = 100;
-
-        ESP_LOGI(TAG, "Chuva Raw: %d | Chuva Pct: %d%%", rain_raw, rain_percent);
-        // Log informativo resumido do ciclo
-        logbuf_add(LOG_LVL_INFO, "SENS", "Leitura sensores concluida");
+    // Publicação por exceção (banda morta/heartbeat), se habilitada
+    deadband_init(cfg);
 
-        // 3. Monta payload JSON com os dados novos
-        // Atualiza telemetria para Dashboard
-        status_set_telemetry(dht_temp, dht_hum, rain_percent);
+    // Fila store-and-forward em flash (recupera pendências do boot anterior)
+    telemq_init();
 
-        // Avalia alertas e aciona LEDs
-        alert_eval_and_log(dht_temp, rain_percent);
-        set_rain_led(alert_get_rain_color());
-        set_temp_led(alert_get_temp_color());
+    static publisher_ctx_t pub = {};
+    pub.client = client;
+    pub.cfg = cfg;
+    xTaskCreate(publisher_task, "publisher", 5120, &pub, tskIDLE_PRIORITY + 4, NULL);
 
-        char payload[150];
-        int len = snprintf(payload, sizeof(payload),
-                           "{\"dht_temp\":%.2f,\"dht_hum\":%.2f,\"rain_pct\":%d}",
-                           dht_temp, dht_hum, rain_percent);
-
-        if (len < 0)
-        {
-            ESP_LOGE(TAG, "Erro ao montar payload");
-            logbuf_add(LOG_LVL_ERROR, "MQTT", "Erro ao montar payload");
-            continue;
-        }
-
-        // Publica no tópico de sensores
-        const char *topic = (cfg->topic[0]) ? cfg->topic : "esp/sensors";
-        int qos = (cfg->qos >= 0 && cfg->qos <= 2) ? cfg->qos : 0;
-        int msg_id = -1;
-        if (client)
-            msg_id = mqtt_publish(client, topic, payload, qos, 0);
-        if (msg_id >= 0)
-        {
-            ESP_LOGI(TAG, "Payload publicado: %s", payload);
-            logbuf_add(LOG_LVL_INFO, "MQTT", "Payload publicado");
-        }
-        else
-        {
-            ESP_LOGE(TAG, "Falha ao publicar MQTT");
-            logbuf_add(LOG_LVL_ERROR, "MQTT", "Falha ao publicar");
-        }
-    }
+    // Amostragem a taxa fixa, desacoplada da publicação
+    sampler_start(SAMPLE_PERIOD_MS);
 }
@@ -0,0 +1,138 @@
+#include "metrics.h"
+#include "sampler.h"
+#include "telemq.h"
+#include "sse.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+std::atomic<uint32_t> g_metrics[MET_COUNT];
+std::atomic<uint32_t> g_http_requests[HTTP_EP_COUNT];
+
+typedef struct {
+    const char *name;
+    const char *help;
+} metric_desc_t;
+
+// Mesma ordem de metric_id_t
+static const metric_desc_t s_desc[MET_COUNT] = {
+    {"station_samples_total", "Amostras capturadas pelo sampler"},
+    {"station_dht_read_failures_total", "Leituras do DHT com erro"},
+    {"station_rain_read_failures_total", "Leituras do FC-37 sem amostras (descartadas)"},
+    {"station_mqtt_publish_total", "Publicacoes MQTT aceitas pelo cliente"},
+    {"station_mqtt_publish_failures_total", "Publicacoes MQTT recusadas"},
+    {"station_mqtt_connects_total", "Conexoes ao broker MQTT"},
+    {"station_mqtt_reconnects_total", "Conexoes ao broker apos uma queda"},
+    {"station_mqtt_disconnects_total", "Desconexoes do broker MQTT"},
+    {"station_wifi_disconnects_total", "Desconexoes do Wi-Fi"},
+};
+
+// Mesma ordem de http_ep_t
+static const char *s_http_ep[HTTP_EP_COUNT] = {
+    "/status", "/api/snapshot", "/logs", "/history", "/api/config", "/events", "/metrics", "static",
+};
+
+// Tasks da aplicação e do sistema cuja folga de stack é exportada
+static const char *s_tasks[] = {
+    "sampler", "publisher", "sse", "logstore", "httpd", "mqtt_task", "tiT", "sys_evt", "esp_timer", "wifi",
+};
+
+// Acumula linhas em 'buf' e envia um chunk quando está quase cheio
+typedef struct {
+    httpd_req_t *req;
+    char buf[512];
+    size_t len;
+    esp_err_t err;
+} writer_t;
+
+static void flush(writer_t *w)
+{
+    if (w->err == ESP_OK && w->len > 0)
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    w->len = 0;
+}
+
+static void emit(writer_t *w, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void emit(writer_t *w, const char *fmt, ...)
+{
+    char line[160];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n <= 0)
+        return;
+    if ((size_t)n >= sizeof(line))
+        n = sizeof(line) - 1;
+    if (w->len + (size_t)n > sizeof(w->buf))
+        flush(w);
+    memcpy(w->buf + w->len, line, (size_t)n);
+    w->len += (size_t)n;
+}
+
+static void emit_header(writer_t *w, const char *name, const char *help, const char *type)
+{
+    emit(w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void emit_gauge(writer_t *w, const char *name, const char *help, unsigned long v)
+{
+    emit_header(w, name, help, "gauge");
+    emit(w, "%s %lu\n", name, v);
+}
+
+esp_err_t metrics_handler(httpd_req_t *req)
+{
+    metrics_http(HTTP_EP_METRICS);
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    writer_t w;
+    w.req = req;
+    w.len = 0;
+    w.err = ESP_OK;
+
+    for (int i = 0; i < MET_COUNT; ++i)
+    {
+        emit_header(&w, s_desc[i].name, s_desc[i].help, "counter");
+        emit(&w, "%s %lu\n", s_desc[i].name, (unsigned long)metrics_get((metric_id_t)i));
+    }
+
+    emit_header(&w, "station_http_requests_total", "Requisicoes HTTP por endpoint", "counter");
+    for (int i = 0; i < HTTP_EP_COUNT; ++i)
+        emit(&w, "station_http_requests_total{endpoint=\"%s\"} %lu\n", s_http_ep[i],
+             (unsigned long)g_http_requests[i].load(std::memory_order_relaxed));
+
+    sampler_stats_t ss = sampler_get_stats();
+    telemq_stats_t qs = telemq_get_stats();
+    sse_stats_t es = sse_get_stats();
+    emit_gauge(&w, "station_sample_queue_depth", "Amostras aguardando o publicador", (unsigned long)ss.depth);
+    emit_gauge(&w, "station_flash_queue_depth", "Amostras pendentes na fila em flash", (unsigned long)qs.depth);
+    emit_gauge(&w, "station_sse_clients", "Clientes conectados em /events", (unsigned long)es.clients);
+
+    emit_gauge(&w, "station_uptime_seconds", "Tempo desde o boot", (unsigned long)(esp_timer_get_time() / 1000000LL));
+    emit_gauge(&w, "station_heap_free_bytes", "Heap livre", (unsigned long)esp_get_free_heap_size());
+    emit_gauge(&w, "station_heap_min_free_bytes", "Menor heap livre desde o boot",
+               (unsigned long)esp_get_minimum_free_heap_size());
+    emit_gauge(&w, "station_heap_largest_free_block_bytes", "Maior bloco livre (fragmentacao)",
+               (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+
+    emit_header(&w, "station_task_stack_free_min_bytes", "Menor folga de stack da task desde o boot", "gauge");
+    for (const char *name : s_tasks)
+    {
+        TaskHandle_t h = xTaskGetHandle(name);
+        if (h)
+            emit(&w, "station_task_stack_free_min_bytes{task=\"%s\"} %lu\n", name,
+                 (unsigned long)uxTaskGetStackHighWaterMark(h));
+    }
+
+    flush(&w);
+    if (w.err != ESP_OK)
+        return w.err;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
@@ -0,0 +1,58 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <atomic>
+#include "esp_http_server.h"
+
+// Contadores para o endpoint /metrics (formato de texto do Prometheus).
+// Cada incremento é um fetch_add relaxado, sem lock: pode ser chamado dos
+// caminhos quentes (amostragem, publicação, handlers HTTP).
+
+typedef enum {
+    MET_SAMPLES = 0,     // amostras capturadas pelo sampler
+    MET_DHT_FAIL,        // leituras do DHT com erro
+    MET_RAIN_FAIL,       // rajadas do FC-37 sem amostras (amostra descartada)
+    MET_MQTT_PUB,        // publicações aceitas pelo cliente MQTT
+    MET_MQTT_PUB_FAIL,   // publicações recusadas
+    MET_MQTT_CONNECT,    // conexões ao broker
+    MET_MQTT_RECONNECT,  // conexões após uma queda
+    MET_MQTT_DISCONNECT,
+    MET_WIFI_DISCONNECT,
+    MET_COUNT
+} metric_id_t;
+
+typedef enum {
+    HTTP_EP_STATUS = 0,
+    HTTP_EP_SNAPSHOT,
+    HTTP_EP_LOGS,
+    HTTP_EP_HISTORY,
+    HTTP_EP_CONFIG,
+    HTTP_EP_EVENTS,
+    HTTP_EP_METRICS,
+    HTTP_EP_FILES,
+    HTTP_EP_COUNT
+} http_ep_t;
+
+extern std::atomic<uint32_t> g_metrics[MET_COUNT];
+extern std::atomic<uint32_t> g_http_requests[HTTP_EP_COUNT];
+
+static inline void metrics_inc(metric_id_t id)
+{
+    g_metrics[id].fetch_add(1, std::memory_order_relaxed);
+}
+
+static inline uint32_t metrics_get(metric_id_t id)
+{
+    return g_metrics[id].load(std::memory_order_relaxed);
+}
+
+static inline void metrics_http(http_ep_t ep)
+{
+    g_http_requests[ep].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Handler de GET /metrics: contadores, heap e stack mínima das tasks
+esp_err_t metrics_handler(httpd_req_t *req);
+
+#endif // METRICS_H
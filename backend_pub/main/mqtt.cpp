@@ -3,6 +3,9 @@
 #include "esp_log.h"
 #include "logbuf.h"
 #include "config.h"
+#include "telemq.h"
+#include "status.h"
+#include "metrics.h"
 
 static const char *TAG = "MQTT";
 
@@ -19,18 +22,26 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         ESP_LOGI(TAG, "MQTT connected");
         logbuf_add(LOG_LVL_INFO, TAG, "MQTT conectado ao broker");
         s_mqtt_connected = true;
+        status_set_mqtt(true);
+        if (metrics_get(MET_MQTT_CONNECT) > 0)
+            metrics_inc(MET_MQTT_RECONNECT);
+        metrics_inc(MET_MQTT_CONNECT);
         esp_mqtt_client_publish(client, "esp/test", "hello", 0, 1, 0);
+        telemq_on_connected();
         break;
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGW(TAG, "MQTT desconectado");
         logbuf_add(LOG_LVL_WARN, TAG, "MQTT desconectado");
+        metrics_inc(MET_MQTT_DISCONNECT);
         s_mqtt_connected = false;
+        status_set_mqtt(false);
         break;
     case MQTT_EVENT_ERROR:
     {
         ESP_LOGE(TAG, "MQTT erro");
         logbuf_add(LOG_LVL_ERROR, TAG, "Erro no cliente MQTT");
         s_mqtt_connected = false;
+        status_set_mqtt(false);
         if (event->error_handle)
         {
             esp_mqtt_error_codes_t *err = event->error_handle;
@@ -51,6 +62,8 @@ esp_mqtt_client_handle_t mqtt_start(const char *uri, int port)
     mqtt_cfg.broker.address.port = port;
     mqtt_cfg.session.keepalive = 60; // seconds
     mqtt_cfg.buffer.size = 2048;     // bytes
+    // Limita o outbox em RAM (QoS>0); o excedente vai para a fila em flash
+    mqtt_cfg.outbox.limit = 8 * 1024; // bytes
 
     // Credenciais do broker (opcionais) puxadas da memória
     const app_config_t *cfg = config_get();
@@ -68,9 +81,9 @@ esp_mqtt_client_handle_t mqtt_start(const char *uri, int port)
     return client;
 }
 
-int mqtt_publish(esp_mqtt_client_handle_t client, const char *topic, const char *payload, int qos, int retain)
+int mqtt_publish(esp_mqtt_client_handle_t client, const char *topic, const char *payload, int len, int qos, int retain)
 {
-    return esp_mqtt_client_publish(client, topic, payload, 0, qos, retain);
+    return esp_mqtt_client_publish(client, topic, payload, len, qos, retain);
 }
 
 bool mqtt_is_connected()
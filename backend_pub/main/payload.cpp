@@ -0,0 +1,143 @@
+#include "payload.h"
+#include <stdio.h>
+#include <math.h>
+
+// Campos de identificação comuns ao JSON simples e ao lote
+static int put_json_id(const sample_t *s, char *out, size_t out_size)
+{
+    if (s->epoch_ms)
+        return snprintf(out, out_size, "\"seq\":%lu,\"boot\":%u,\"ts_ms\":%lu,\"epoch_ms\":%llu,",
+                        (unsigned long)s->seq, (unsigned)s->boot, (unsigned long)(s->ts_us / 1000),
+                        (unsigned long long)s->epoch_ms);
+    return snprintf(out, out_size, "\"seq\":%lu,\"boot\":%u,\"ts_ms\":%lu,",
+                    (unsigned long)s->seq, (unsigned)s->boot, (unsigned long)(s->ts_us / 1000));
+}
+
+int payload_encode_json(const sample_t *s, char *out, size_t out_size)
+{
+    if (out_size < 2)
+        return -1;
+    out[0] = '{';
+    int id = put_json_id(s, out + 1, out_size - 1);
+    if (id < 0 || (size_t)id + 1 >= out_size)
+        return -1;
+    size_t written = 1 + (size_t)id;
+    int len = snprintf(out + written, out_size - written,
+                       "\"dht_temp\":%.2f,\"dht_hum\":%.2f,\"rain_pct\":%d}",
+                       s->temp, s->hum, s->rain_pct);
+    if (len < 0 || written + (size_t)len >= out_size)
+        return -1;
+    return (int)(written + (size_t)len);
+}
+
+int payload_encode_json_batch(const sample_t *s, int n, bool replay, char *out, size_t out_size)
+{
+    int len = snprintf(out, out_size, replay ? "{\"replay\":true,\"samples\":[" : "{\"samples\":[");
+    if (len < 0 || (size_t)len >= out_size)
+        return -1;
+    size_t written = (size_t)len;
+
+    for (int i = 0; i < n; ++i)
+    {
+        len = snprintf(out + written, out_size - written, i > 0 ? ",{" : "{");
+        if (len < 0 || written + (size_t)len >= out_size)
+            return -1;
+        written += (size_t)len;
+        len = put_json_id(&s[i], out + written, out_size - written);
+        if (len < 0 || written + (size_t)len >= out_size)
+            return -1;
+        written += (size_t)len;
+        len = snprintf(out + written, out_size - written,
+                       "\"dht_temp\":%.2f,\"dht_hum\":%.2f,\"rain_pct\":%d}",
+                       s[i].temp, s[i].hum, s[i].rain_pct);
+        if (len < 0 || written + (size_t)len >= out_size)
+            return -1;
+        written += (size_t)len;
+    }
+
+    len = snprintf(out + written, out_size - written, "]}");
+    if (len < 0 || written + (size_t)len >= out_size)
+        return -1;
+    return (int)(written + (size_t)len);
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)(v & 0xFFFF));
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, (uint32_t)(v & 0xFFFFFFFFu));
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+// Ponto fixo com 2 casas: arredonda e satura na faixa do tipo
+int16_t payload_temp_to_fixed(float t)
+{
+    if (isnan(t))
+        return INT16_MIN;
+    float v = roundf(t * 100.0f);
+    if (v > INT16_MAX)
+        v = INT16_MAX;
+    if (v <= INT16_MIN)
+        v = INT16_MIN + 1;
+    return (int16_t)v;
+}
+
+uint16_t payload_hum_to_fixed(float h)
+{
+    if (isnan(h))
+        return 0xFFFF;
+    float v = roundf(h * 100.0f);
+    if (v < 0)
+        v = 0;
+    if (v > 10000)
+        v = 10000;
+    return (uint16_t)v;
+}
+
+int payload_encode_bin(const sample_t *s, int n, bool replay, uint8_t *out, size_t out_size)
+{
+    if (n < 0 || n > 255)
+        return -1;
+    size_t total = PAYLOAD_BIN_HEADER_LEN + (size_t)n * PAYLOAD_BIN_SAMPLE_LEN;
+    if (total > out_size)
+        return -1;
+
+    out[0] = PAYLOAD_BIN_MAGIC;
+    out[1] = PAYLOAD_BIN_VERSION;
+    out[2] = (uint8_t)n;
+    out[3] = replay ? PAYLOAD_BIN_HDR_REPLAY : 0;
+
+    uint8_t *p = out + PAYLOAD_BIN_HEADER_LEN;
+    for (int i = 0; i < n; ++i, p += PAYLOAD_BIN_SAMPLE_LEN)
+    {
+        put_u32(p, (uint32_t)(s[i].ts_us / 1000));
+        put_u16(p + 4, (uint16_t)payload_temp_to_fixed(s[i].temp));
+        put_u16(p + 6, payload_hum_to_fixed(s[i].hum));
+        p[8] = (uint8_t)(s[i].rain_pct < 0 ? 0 : s[i].rain_pct > 100 ? 100 : s[i].rain_pct);
+        p[9] = s[i].dht_ok ? PAYLOAD_BIN_FLAG_DHT_OK : 0;
+        put_u32(p + 10, s[i].seq);
+        put_u16(p + 14, s[i].boot);
+        put_u64(p + 16, s[i].epoch_ms);
+    }
+    return (int)total;
+}
+
+float payload_temp_from_fixed(int16_t v)
+{
+    return v == INT16_MIN ? NAN : v / 100.0f;
+}
+
+float payload_hum_from_fixed(uint16_t v)
+{
+    return v == 0xFFFF ? NAN : v / 100.0f;
+}
@@ -0,0 +1,51 @@
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sampler.h"
+
+#define PAYLOAD_BATCH_MAX 16 // limite de amostras por mensagem em lote
+
+typedef enum {
+    PAYLOAD_FMT_JSON = 0,
+    PAYLOAD_FMT_BINARY = 1
+} payload_fmt_t;
+
+// Formato binário v2 (little-endian), tamanho fixo por amostra:
+//   cabeçalho: [0]=PAYLOAD_BIN_MAGIC [1]=versão [2]=n amostras [3]=flags do lote
+//   amostra:   u32 ts_ms | i16 temp_c*100 | u16 hum*100 | u8 rain_pct | u8 flags |
+//              u32 seq | u16 boot | u64 epoch_ms (0 = sem SNTP)
+// A v1 tinha só os primeiros 10 bytes de cada amostra.
+// Temperatura/umidade inválidas (NaN) são codificadas como INT16_MIN/0xFFFF.
+// O primeiro byte nunca é '{', o que permite ao assinante distinguir de JSON.
+#define PAYLOAD_BIN_MAGIC 0xB7
+#define PAYLOAD_BIN_VERSION 2
+#define PAYLOAD_BIN_HEADER_LEN 4
+#define PAYLOAD_BIN_SAMPLE_LEN 24
+#define PAYLOAD_BIN_FLAG_DHT_OK 0x01
+#define PAYLOAD_BIN_HDR_REPLAY 0x01 // lote reenviado da fila em flash
+
+// Codifica uma amostra no formato JSON histórico, com a identificação:
+// {"seq":..,"boot":..,"ts_ms":..[,"epoch_ms":..],"dht_temp":..,"dht_hum":..,"rain_pct":..}
+// Retorna o número de bytes escritos ou -1 se não couber.
+int payload_encode_json(const sample_t *s, char *out, size_t out_size);
+
+// Codifica 'n' amostras em uma única mensagem, em ordem de captura:
+// {"samples":[{"seq":..,"boot":..,"ts_ms":..,"dht_temp":..,...},...]}
+// 'replay' marca amostras antigas reenviadas ({"replay":true,"samples":[...]}),
+// que o assinante não deve tratar como leitura atual.
+int payload_encode_json_batch(const sample_t *s, int n, bool replay, char *out, size_t out_size);
+
+// Codifica 'n' amostras no formato binário v2 (PAYLOAD_BIN_VERSION):
+// cabeçalho de 4 bytes + 24 bytes por amostra, layout acima.
+// Retorna o número de bytes escritos ou -1 se não couber.
+int payload_encode_bin(const sample_t *s, int n, bool replay, uint8_t *out, size_t out_size);
+
+// Conversões de ponto fixo (x100) compartilhadas com o armazenamento em flash
+int16_t payload_temp_to_fixed(float t);
+uint16_t payload_hum_to_fixed(float h);
+float payload_temp_from_fixed(int16_t v);
+float payload_hum_from_fixed(uint16_t v);
+
+#endif // PAYLOAD_H
@@ -0,0 +1,54 @@
+#include "rain_filter.h"
+#include <string.h>
+#include <algorithm>
+
+void rain_filter_init(rain_filter_t *f, rain_source_t src)
+{
+    memset(f, 0, sizeof(*f));
+    f->src = src;
+}
+
+uint16_t rain_filter_median(uint16_t *buf, int n)
+{
+    if (n <= 0)
+        return 0;
+    // Seleção parcial O(n): descarta picos sem ordenar a rajada inteira
+    std::nth_element(buf, buf + n / 2, buf + n);
+    return buf[n / 2];
+}
+
+uint16_t rain_filter_push(rain_filter_t *f, uint16_t median)
+{
+    if (f->filled == RAIN_AVG_LEN)
+        f->sum -= f->hist[f->idx];
+    else
+        f->filled++;
+    f->hist[f->idx] = median;
+    f->sum += median;
+    f->idx = (uint8_t)((f->idx + 1) % RAIN_AVG_LEN);
+    return (uint16_t)(f->sum / f->filled);
+}
+
+int rain_raw_to_pct(int raw)
+{
+    // 0% = seco (ADC alto), 100% = chuva forte (ADC baixo)
+    int pct = 100 - ((raw * 100) / RAIN_ADC_MAX);
+    if (pct < 0)
+        pct = 0;
+    if (pct > 100)
+        pct = 100;
+    return pct;
+}
+
+int rain_filter_acquire(rain_filter_t *f, int *raw_out)
+{
+    uint16_t burst[RAIN_BURST_LEN];
+    int n = f->src.read ? f->src.read(f->src.ctx, burst, RAIN_BURST_LEN) : 0;
+    if (n <= 0)
+        return -1;
+
+    uint16_t avg = rain_filter_push(f, rain_filter_median(burst, n));
+    if (raw_out)
+        *raw_out = avg;
+    return rain_raw_to_pct(avg);
+}
@@ -0,0 +1,41 @@
+#ifndef RAIN_FILTER_H
+#define RAIN_FILTER_H
+
+#include <stdint.h>
+
+// Módulo sem dependências do ESP-IDF: a origem das amostras é plugável,
+// permitindo rodar o mesmo filtro no host sobre traços gravados.
+
+#define RAIN_BURST_LEN 32 // amostras ADC por rajada (mediana)
+#define RAIN_AVG_LEN 4    // medianas na média móvel
+#define RAIN_ADC_MAX 4095 // ADC de 12 bits
+
+// Preenche 'buf' com até 'n' leituras brutas; retorna quantas foram lidas
+typedef int (*rain_source_read_t)(void *ctx, uint16_t *buf, int n);
+
+typedef struct {
+    rain_source_read_t read;
+    void *ctx;
+} rain_source_t;
+
+typedef struct {
+    rain_source_t src;
+    uint16_t hist[RAIN_AVG_LEN]; // últimas medianas
+    uint32_t sum;                // soma de hist[] (média móvel O(1))
+    uint8_t idx;
+    uint8_t filled;
+} rain_filter_t;
+
+void rain_filter_init(rain_filter_t *f, rain_source_t src);
+
+// Lê uma rajada, aplica mediana + média móvel e devolve a % de chuva.
+// Retorna -1 se a origem não forneceu amostras. 'raw_out' (opcional)
+// recebe o valor bruto filtrado.
+int rain_filter_acquire(rain_filter_t *f, int *raw_out);
+
+// Etapas expostas para testes/benchmark no host
+uint16_t rain_filter_median(uint16_t *buf, int n); // reordena 'buf'
+uint16_t rain_filter_push(rain_filter_t *f, uint16_t median);
+int rain_raw_to_pct(int raw);
+
+#endif // RAIN_FILTER_H
@@ -0,0 +1,195 @@
+#include "sampler.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/adc.h"
+#include "dht.h"
+#include "logbuf.h"
+#include "metrics.h"
+#include "rain_filter.h"
+#include <math.h>
+#include <atomic>
+
+static const char *TAG = "SAMPLER";
+
+// Sensor configuration
+#define DHT_GPIO GPIO_NUM_21
+#define DHT_TYPE DHT_TYPE_DHT11
+
+// GPIO 34 corresponde ao ADC1_CHANNEL_6.
+#define RAIN_ADC_CHANNEL ADC1_CHANNEL_6
+
+static_assert((SAMPLER_QUEUE_LEN & (SAMPLER_QUEUE_LEN - 1)) == 0, "SAMPLER_QUEUE_LEN deve ser potencia de 2");
+
+// Fila SPSC sem lock: apenas a task de amostragem escreve em s_tail e
+// apenas o consumidor escreve em s_head. Índices crescem livremente e são
+// mascarados no acesso, de modo que (tail - head) é a ocupação.
+static sample_t s_ring[SAMPLER_QUEUE_LEN];
+static std::atomic<uint32_t> s_head{0};
+static std::atomic<uint32_t> s_tail{0};
+static std::atomic<TaskHandle_t> s_consumer{nullptr};
+
+static uint32_t s_period_ms = 5000;
+static std::atomic<uint32_t> s_produced{0};
+static std::atomic<uint32_t> s_dropped{0};
+static std::atomic<uint32_t> s_max_depth{0};
+static std::atomic<int32_t> s_jitter_last_us{0};
+static std::atomic<int32_t> s_jitter_max_us{0};
+
+static bool ring_push(const sample_t *s)
+{
+    uint32_t tail = s_tail.load(std::memory_order_relaxed);
+    uint32_t head = s_head.load(std::memory_order_acquire);
+    if (tail - head >= SAMPLER_QUEUE_LEN)
+        return false;
+    s_ring[tail & (SAMPLER_QUEUE_LEN - 1)] = *s;
+    s_tail.store(tail + 1, std::memory_order_release);
+
+    uint32_t depth = tail + 1 - head;
+    if (depth > s_max_depth.load(std::memory_order_relaxed))
+        s_max_depth.store(depth, std::memory_order_relaxed);
+    return true;
+}
+
+static bool ring_pop(sample_t *out)
+{
+    uint32_t head = s_head.load(std::memory_order_relaxed);
+    uint32_t tail = s_tail.load(std::memory_order_acquire);
+    if (head == tail)
+        return false;
+    *out = s_ring[head & (SAMPLER_QUEUE_LEN - 1)];
+    s_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+static rain_filter_t s_rain;
+
+// Origem de amostras do FC-37: rajada de leituras one-shot no ADC1.
+// O driver legado (driver/adc.h) não expõe o modo contínuo/DMA para o ADC1
+// de forma portável, e 32 leituras custam poucas centenas de microssegundos.
+static int adc_rain_read(void *ctx, uint16_t *buf, int n)
+{
+    int got = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        int raw = adc1_get_raw(RAIN_ADC_CHANNEL);
+        if (raw < 0)
+            continue;
+        buf[got++] = (uint16_t)raw;
+    }
+    return got;
+}
+
+// Retorna false se o ADC não forneceu amostras: nesse caso não há leitura
+// de chuva válida (0% seria publicado como "seco" e limparia o alerta)
+static bool read_rain_pct(int *out)
+{
+    int rain_raw = 0;
+    int rain_percent = rain_filter_acquire(&s_rain, &rain_raw);
+    if (rain_percent < 0)
+    {
+        logbuf_add(LOG_LVL_WARN, "ADC", "Falha ao ler FC-37");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Chuva Raw: %d | Chuva Pct: %d%%", rain_raw, rain_percent);
+    *out = rain_percent;
+    return true;
+}
+
+static void sampler_task(void *arg)
+{
+    const TickType_t period = pdMS_TO_TICKS(s_period_ms);
+    TickType_t last_wake = xTaskGetTickCount();
+    int64_t next_us = esp_timer_get_time() + (int64_t)s_period_ms * 1000;
+
+    while (1)
+    {
+        // Agenda pelo instante absoluto: leituras lentas não deslocam o próximo ciclo
+        vTaskDelayUntil(&last_wake, period);
+
+        int64_t now_us = esp_timer_get_time();
+        int32_t jitter = (int32_t)(now_us - next_us);
+        next_us += (int64_t)s_period_ms * 1000;
+        s_jitter_last_us.store(jitter, std::memory_order_relaxed);
+        if (jitter > s_jitter_max_us.load(std::memory_order_relaxed))
+            s_jitter_max_us.store(jitter, std::memory_order_relaxed);
+
+        sample_t s = {};
+        s.ts_us = now_us;
+        s.temp = NAN;
+        s.hum = NAN;
+
+        // 1. Leitura DHT
+        esp_err_t dht_res = dht_read_float_data(DHT_TYPE, DHT_GPIO, &s.hum, &s.temp);
+        s.dht_ok = (dht_res == ESP_OK);
+        metrics_inc(MET_SAMPLES);
+        if (!s.dht_ok)
+        {
+            metrics_inc(MET_DHT_FAIL);
+            ESP_LOGW(TAG, "Falha ao ler DHT: %d", (int)dht_res);
+            logbuf_add(LOG_LVL_WARN, "DHT", "Falha ao ler DHT");
+        }
+
+        // 2. Leitura FC-37 (sem leitura válida a amostra é descartada)
+        if (!read_rain_pct(&s.rain_pct))
+        {
+            metrics_inc(MET_RAIN_FAIL);
+            continue;
+        }
+
+        if (ring_push(&s))
+        {
+            s_produced.fetch_add(1, std::memory_order_relaxed);
+            TaskHandle_t consumer = s_consumer.load(std::memory_order_acquire);
+            if (consumer)
+                xTaskNotifyGive(consumer);
+        }
+        else
+        {
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+            logbuf_add(LOG_LVL_WARN, "SENS", "Fila de amostras cheia, amostra descartada");
+        }
+    }
+}
+
+void sampler_start(uint32_t period_ms)
+{
+    s_period_ms = period_ms ? period_ms : 5000;
+
+    // Configura resolução de 12 bits (0 a 4095)
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    // Configura atenuação para ler a faixa completa de 0 a ~3.3V
+    adc1_config_channel_atten(RAIN_ADC_CHANNEL, ADC_ATTEN_DB_11);
+    rain_source_t src = {adc_rain_read, NULL};
+    rain_filter_init(&s_rain, src);
+    logbuf_add(LOG_LVL_INFO, "ADC", "ADC FC-37 configurado");
+
+    // Prioridade acima do publicador para que a cadência não dependa da rede
+    xTaskCreate(sampler_task, "sampler", 3072, NULL, tskIDLE_PRIORITY + 5, NULL);
+}
+
+bool sampler_pop(sample_t *out, TickType_t wait)
+{
+    if (!out)
+        return false;
+    s_consumer.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    if (ring_pop(out))
+        return true;
+    // Fila vazia: aguarda notificação do produtor e tenta de novo
+    ulTaskNotifyTake(pdTRUE, wait);
+    return ring_pop(out);
+}
+
+sampler_stats_t sampler_get_stats()
+{
+    sampler_stats_t st = {};
+    st.produced = s_produced.load(std::memory_order_relaxed);
+    st.dropped = s_dropped.load(std::memory_order_relaxed);
+    st.depth = s_tail.load(std::memory_order_acquire) - s_head.load(std::memory_order_acquire);
+    st.max_depth = s_max_depth.load(std::memory_order_relaxed);
+    st.jitter_last_us = s_jitter_last_us.load(std::memory_order_relaxed);
+    st.jitter_max_us = s_jitter_max_us.load(std::memory_order_relaxed);
+    return st;
+}
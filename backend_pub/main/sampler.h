@@ -0,0 +1,40 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+#define SAMPLER_QUEUE_LEN 16 // potência de 2 (fila SPSC)
+
+typedef struct {
+    int64_t ts_us;  // instante da captura (uptime em us)
+    float temp;     // NAN quando a leitura do DHT falha
+    float hum;
+    int rain_pct;
+    bool dht_ok;
+    // Preenchidos pela task publicadora quando a amostra entra em um lote:
+    uint32_t seq;      // sequência por boot das amostras publicadas (a partir de 1)
+    uint16_t boot;     // contador de boots (timesync)
+    uint64_t epoch_ms; // captura em epoch (SNTP); 0 = relógio não sincronizado
+} sample_t;
+
+typedef struct {
+    uint32_t produced;      // amostras colocadas na fila
+    uint32_t dropped;       // amostras descartadas com fila cheia
+    uint32_t depth;         // ocupação atual da fila
+    uint32_t max_depth;     // maior ocupação observada
+    int32_t jitter_last_us; // atraso do último despertar em relação ao agendado
+    int32_t jitter_max_us;  // pior atraso observado
+} sampler_stats_t;
+
+// Configura os sensores e inicia a task de amostragem a taxa fixa
+void sampler_start(uint32_t period_ms);
+
+// Retira a amostra mais antiga da fila (consumidor único).
+// Bloqueia até 'wait' ticks quando a fila está vazia.
+bool sampler_pop(sample_t *out, TickType_t wait);
+
+sampler_stats_t sampler_get_stats();
+
+#endif // SAMPLER_H
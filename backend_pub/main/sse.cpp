@@ -0,0 +1,313 @@
+#include "sse.h"
+#include "logbuf.h"
+#include "metrics.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <new>
+
+static const char *TAG = "SSE";
+
+// Frame serializado uma única vez e compartilhado entre as filas
+typedef struct {
+    std::atomic<int> refs;
+    size_t len;
+    char data[];
+} sse_frame_t;
+
+typedef struct {
+    int fd;       // -1 = livre
+    uint32_t gen; // incrementado a cada conexão no slot (fd pode ser reusado)
+    sse_frame_t *q[SSE_QUEUE_LEN];
+    uint8_t head;  // próximo a enviar
+    uint8_t count;
+    bool pending;  // envio já enfileirado na task do httpd
+} sse_client_t;
+
+// Argumento do trabalho de envio, sem alocação: slot | ping | geração
+#define SSE_WORK_SLOT_BITS 2
+#define SSE_WORK_PING 0x4u
+#define SSE_WORK_GEN_SHIFT 3
+static_assert(SSE_MAX_CLIENTS <= (1 << SSE_WORK_SLOT_BITS), "slot nao cabe no argumento do trabalho");
+
+static httpd_handle_t s_server = nullptr;
+static TaskHandle_t s_task = nullptr;
+static SemaphoreHandle_t s_lock = nullptr;
+static sse_client_t s_clients[SSE_MAX_CLIENTS];
+static uint32_t s_log_cursor = 0; // última sequência do logbuf já publicada
+
+static std::atomic<uint32_t> s_nclients{0};
+static std::atomic<uint32_t> s_published{0};
+static std::atomic<uint32_t> s_sent{0};
+static std::atomic<uint32_t> s_dropped{0};
+
+static void frame_unref(sse_frame_t *f)
+{
+    if (f && f->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        free(f);
+}
+
+// Remove o cliente e libera os frames pendentes (chamar com s_lock)
+static void client_release(sse_client_t *c)
+{
+    while (c->count > 0)
+    {
+        frame_unref(c->q[c->head]);
+        c->head = (uint8_t)((c->head + 1) % SSE_QUEUE_LEN);
+        c->count--;
+    }
+    c->fd = -1;
+    c->head = 0;
+    c->pending = false;
+    s_nclients.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Chamado pelo httpd quando a sessão do cliente é encerrada
+static void sse_sess_free(void *ctx)
+{
+    int fd = (int)(intptr_t)ctx;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (auto &c : s_clients)
+    {
+        if (c.fd == fd)
+            client_release(&c);
+    }
+    xSemaphoreGive(s_lock);
+}
+
+static void enqueue(sse_frame_t *f)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (auto &c : s_clients)
+    {
+        if (c.fd < 0)
+            continue;
+        // Fila cheia: descarta o mais antigo (cliente lento)
+        if (c.count == SSE_QUEUE_LEN)
+        {
+            frame_unref(c.q[c.head]);
+            c.head = (uint8_t)((c.head + 1) % SSE_QUEUE_LEN);
+            c.count--;
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        f->refs.fetch_add(1, std::memory_order_relaxed);
+        c.q[(c.head + c.count) % SSE_QUEUE_LEN] = f;
+        c.count++;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+void sse_publish(const char *event, const char *json)
+{
+    if (!s_task || s_nclients.load(std::memory_order_relaxed) == 0)
+        return;
+
+    size_t cap = strlen(event) + strlen(json) + 20;
+    sse_frame_t *f = (sse_frame_t *)malloc(sizeof(sse_frame_t) + cap);
+    if (!f)
+        return;
+    new (&f->refs) std::atomic<int>(1); // referência do publicador
+    int n = snprintf(f->data, cap, "event: %s\ndata: %s\n\n", event, json);
+    f->len = n > 0 ? (size_t)n : 0;
+
+    enqueue(f);
+    frame_unref(f);
+    s_published.fetch_add(1, std::memory_order_relaxed);
+    xTaskNotifyGive(s_task);
+}
+
+// Publica as entradas novas do logbuf como eventos "log"
+static void publish_logs(void)
+{
+    uint32_t upto = logbuf_committed_seq();
+    if (s_nclients.load(std::memory_order_relaxed) == 0)
+    {
+        s_log_cursor = upto;
+        return;
+    }
+    uint32_t first = upto > LOGBUF_MAX ? upto - LOGBUF_MAX + 1 : 1;
+    uint32_t seq = s_log_cursor + 1 > first ? s_log_cursor + 1 : first;
+    char json[256];
+    for (; seq <= upto && seq != 0; ++seq)
+    {
+        log_entry_t e;
+        if (logbuf_read(seq, &e) && logbuf_entry_json(&e, json, sizeof(json)) > 0)
+            sse_publish("log", json);
+    }
+    s_log_cursor = upto;
+}
+
+static void logbuf_notify(void)
+{
+    if (s_task)
+        xTaskNotifyGive(s_task);
+}
+
+// Executa na task do httpd, a mesma que encerra sessões: enquanto roda, o
+// fd do slot não pode ser fechado nem reusado. Confere a geração para não
+// enviar a uma conexão nova que tenha herdado o slot/fd.
+static void sse_send_work(void *arg)
+{
+    uintptr_t v = (uintptr_t)arg;
+    sse_client_t *c = &s_clients[v & ((1u << SSE_WORK_SLOT_BITS) - 1)];
+    uint32_t gen = (uint32_t)(v >> SSE_WORK_GEN_SHIFT);
+    bool ping = (v & SSE_WORK_PING) != 0;
+    for (;;)
+    {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (c->fd < 0 || (c->gen & (UINTPTR_MAX >> SSE_WORK_GEN_SHIFT)) != gen)
+        {
+            xSemaphoreGive(s_lock);
+            return; // sessão encerrada; client_release já limpou 'pending'
+        }
+        int fd = c->fd;
+        sse_frame_t *f = nullptr;
+        if (c->count > 0)
+        {
+            f = c->q[c->head];
+            c->head = (uint8_t)((c->head + 1) % SSE_QUEUE_LEN);
+            c->count--;
+        }
+        else if (!ping)
+        {
+            c->pending = false;
+            xSemaphoreGive(s_lock);
+            return;
+        }
+        xSemaphoreGive(s_lock);
+
+        // Sem eventos no intervalo: comentário mantém a conexão viva
+        const char *data = f ? f->data : ": ping\n\n";
+        size_t len = f ? f->len : 8;
+        int r = httpd_socket_send(s_server, fd, data, len, 0);
+        frame_unref(f);
+        ping = false;
+        if (r < 0)
+        {
+            ESP_LOGW(TAG, "Cliente fd=%d desconectado", fd);
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            c->pending = false;
+            xSemaphoreGive(s_lock);
+            httpd_sess_trigger_close(s_server, fd);
+            return;
+        }
+        if (f)
+            s_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Agenda o esvaziamento das filas na task do httpd (um trabalho por cliente)
+static void sse_task(void *arg)
+{
+    for (;;)
+    {
+        bool woke = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SSE_KEEPALIVE_MS)) > 0;
+        publish_logs();
+
+        for (int i = 0; i < SSE_MAX_CLIENTS; ++i)
+        {
+            sse_client_t *c = &s_clients[i];
+            uintptr_t arg = 0;
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            bool queue = c->fd >= 0 && !c->pending && (c->count > 0 || !woke);
+            if (queue)
+            {
+                c->pending = true;
+                arg = ((uintptr_t)c->gen << SSE_WORK_GEN_SHIFT) | (woke ? 0 : SSE_WORK_PING) | (uintptr_t)i;
+            }
+            uint32_t gen = c->gen;
+            xSemaphoreGive(s_lock);
+            if (!queue)
+                continue;
+            if (httpd_queue_work(s_server, sse_send_work, (void *)arg) != ESP_OK)
+            {
+                // Fila do httpd cheia: tenta de novo no próximo despertar
+                xSemaphoreTake(s_lock, portMAX_DELAY);
+                if (c->gen == gen)
+                    c->pending = false;
+                xSemaphoreGive(s_lock);
+            }
+        }
+    }
+}
+
+void sse_init(httpd_handle_t server)
+{
+    s_server = server;
+    for (auto &c : s_clients)
+    {
+        c.fd = -1;
+        c.gen = 0;
+        c.pending = false;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    s_log_cursor = logbuf_committed_seq();
+    xTaskCreate(sse_task, "sse", 3072, NULL, tskIDLE_PRIORITY + 2, &s_task);
+    logbuf_set_notify(logbuf_notify);
+}
+
+esp_err_t sse_events_handler(httpd_req_t *req)
+{
+    metrics_http(HTTP_EP_EVENTS);
+    int fd = httpd_req_to_sockfd(req);
+    int slot = -1;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < SSE_MAX_CLIENTS; ++i)
+    {
+        if (s_clients[i].fd < 0)
+        {
+            slot = i;
+            s_clients[i].fd = fd;
+            s_clients[i].gen++;
+            s_clients[i].head = 0;
+            s_clients[i].count = 0;
+            s_clients[i].pending = false;
+            s_nclients.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    if (slot < 0)
+    {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "10");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    // Cabeçalho enviado manualmente: a conexão fica aberta após o handler
+    // e os eventos seguem pela task de envio
+    static const char hdr[] = "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: text/event-stream\r\n"
+                              "Cache-Control: no-cache\r\n"
+                              "Connection: keep-alive\r\n\r\n"
+                              "retry: 3000\n\n";
+    if (httpd_send(req, hdr, sizeof(hdr) - 1) < 0)
+    {
+        sse_sess_free((void *)(intptr_t)fd);
+        return ESP_FAIL;
+    }
+    req->sess_ctx = (void *)(intptr_t)fd;
+    req->free_ctx = sse_sess_free;
+    ESP_LOGI(TAG, "Cliente SSE conectado (fd=%d)", fd);
+    return ESP_OK;
+}
+
+uint32_t sse_client_count(void)
+{
+    return s_nclients.load(std::memory_order_relaxed);
+}
+
+sse_stats_t sse_get_stats(void)
+{
+    sse_stats_t st = {};
+    st.clients = s_nclients.load(std::memory_order_relaxed);
+    st.published = s_published.load(std::memory_order_relaxed);
+    st.sent = s_sent.load(std::memory_order_relaxed);
+    st.dropped = s_dropped.load(std::memory_order_relaxed);
+    return st;
+}
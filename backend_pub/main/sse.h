@@ -0,0 +1,38 @@
+#ifndef SSE_H
+#define SSE_H
+
+#include <stdint.h>
+#include "esp_http_server.h"
+
+// Canal Server-Sent Events (/events): eventos de telemetria publicados pela
+// task de amostragem e de log (novas entradas do logbuf) são empurrados aos
+// dashboards. Cada evento é serializado uma vez em um frame compartilhado
+// (contagem de referências); cada cliente tem uma fila limitada que descarta
+// o mais antigo quando o cliente é lento. Os envios rodam na task do httpd
+// (httpd_queue_work), conferindo a geração da conexão no slot.
+
+#define SSE_MAX_CLIENTS 3
+#define SSE_QUEUE_LEN 8          // frames pendentes por cliente
+#define SSE_KEEPALIVE_MS 15000   // comentário ": ping" em conexões ociosas
+
+typedef struct {
+    uint32_t clients;   // conexões abertas
+    uint32_t published; // eventos publicados
+    uint32_t sent;      // frames entregues (somando clientes)
+    uint32_t dropped;   // frames descartados por fila cheia
+} sse_stats_t;
+
+// Inicia a task de envio e passa a acompanhar o logbuf
+void sse_init(httpd_handle_t server);
+
+// Handler de GET /events
+esp_err_t sse_events_handler(httpd_req_t *req);
+
+// Enfileira "event: <event>\ndata: <json>\n\n" para todos os clientes
+void sse_publish(const char *event, const char *json);
+
+uint32_t sse_client_count(void);
+
+sse_stats_t sse_get_stats(void);
+
+#endif // SSE_H
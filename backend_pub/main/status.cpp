@@ -1,12 +1,96 @@
 #include "status.h"
+#include "wifi.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
 
 static telemetry_t s_last = {0};
 
+static SemaphoreHandle_t s_lock = nullptr;
+static net_status_t s_net = {}; // zerada: memcmp em net_refresh compara o padding
+static std::atomic<uint32_t> s_version{1};
+static esp_timer_handle_t s_rssi_timer = nullptr;
+
+static void bump(void)
+{
+    s_version.fetch_add(1, std::memory_order_release);
+}
+
+// Relê IP/gateway (e RSSI, se pedido) e publica só se algo mudou
+static void net_refresh(bool with_rssi)
+{
+    net_status_t n;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    n = s_net;
+    xSemaphoreGive(s_lock);
+
+    n.ap_mode = wifi_mode_is_ap();
+    n.wifi_connected = wifi_is_connected();
+    strcpy(n.ip, "0.0.0.0");
+    strcpy(n.gw, "0.0.0.0");
+    esp_netif_t *netif = wifi_get_netif();
+    esp_netif_ip_info_t ip_info;
+    if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK)
+    {
+        snprintf(n.ip, sizeof(n.ip), "%d.%d.%d.%d", IP2STR(&ip_info.ip));
+        snprintf(n.gw, sizeof(n.gw), "%d.%d.%d.%d", IP2STR(&ip_info.gw));
+    }
+    // RSSI somente em modo STA conectado
+    if (n.ap_mode || !n.wifi_connected)
+    {
+        n.rssi = -127;
+    }
+    else if (with_rssi)
+    {
+        wifi_ap_record_t ap;
+        if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK)
+            n.rssi = ap.rssi;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool changed = memcmp(&n, &s_net, sizeof(n)) != 0;
+    s_net = n;
+    xSemaphoreGive(s_lock);
+    if (changed)
+        bump();
+}
+
+static void net_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data)
+{
+    net_refresh(base == IP_EVENT);
+}
+
+static void rssi_timer_cb(void *arg)
+{
+    net_refresh(true);
+}
+
+void status_init(void)
+{
+    s_lock = xSemaphoreCreateMutex();
+    strcpy(s_net.ip, "0.0.0.0");
+    strcpy(s_net.gw, "0.0.0.0");
+    s_net.rssi = -127;
+
+    esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &net_event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, ESP_EVENT_ANY_ID, &net_event_handler, NULL);
+
+    esp_timer_create_args_t args = {};
+    args.callback = rssi_timer_cb;
+    args.name = "status_rssi";
+    esp_timer_create(&args, &s_rssi_timer);
+    esp_timer_start_periodic(s_rssi_timer, (uint64_t)STATUS_RSSI_PERIOD_MS * 1000ULL);
+    net_refresh(true);
+}
+
 void status_set_telemetry(float temp, float hum, int rain_pct)
 {
     s_last.temp = temp;
     s_last.hum = hum;
     s_last.rain_pct = rain_pct;
+    bump();
 }
 
 telemetry_t status_get_telemetry()
@@ -14,3 +98,36 @@ telemetry_t status_get_telemetry()
     return s_last;
 }
 
+void status_set_mqtt(bool connected)
+{
+    if (!s_lock)
+        return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool changed = s_net.mqtt_connected != connected;
+    s_net.mqtt_connected = connected;
+    xSemaphoreGive(s_lock);
+    if (changed)
+        bump();
+}
+
+net_status_t status_get_net(void)
+{
+    net_status_t n;
+    if (!s_lock)
+    {
+        memset(&n, 0, sizeof(n));
+        strcpy(n.ip, "0.0.0.0");
+        strcpy(n.gw, "0.0.0.0");
+        n.rssi = -127;
+        return n;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    n = s_net;
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+uint32_t status_version(void)
+{
+    return s_version.load(std::memory_order_acquire);
+}
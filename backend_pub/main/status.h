@@ -1,14 +1,38 @@
 #ifndef STATUS_H
 #define STATUS_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 typedef struct {
     float temp;
     float hum;
     int rain_pct;
 } telemetry_t;
 
+// Estado de rede mantido pelos eventos de Wi-Fi/IP/MQTT e por um timer
+// lento de RSSI; leitura sem chamadas ao driver
+typedef struct {
+    bool wifi_connected;
+    bool ap_mode;
+    bool mqtt_connected;
+    char ip[16];
+    char gw[16];
+    int rssi; // dBm; -127 quando indisponível
+} net_status_t;
+
+#define STATUS_RSSI_PERIOD_MS 10000
+
+// Registra os eventos e o timer de RSSI (chamar após wifi_init)
+void status_init(void);
+
 void status_set_telemetry(float temp, float hum, int rain_pct);
 telemetry_t status_get_telemetry();
 
-#endif // STATUS_H
+void status_set_mqtt(bool connected);
+net_status_t status_get_net(void);
 
+// Incrementa a cada mudança de rede, RSSI ou telemetria
+uint32_t status_version(void);
+
+#endif // STATUS_H
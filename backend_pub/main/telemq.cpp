@@ -0,0 +1,284 @@
+#include "telemq.h"
+#include "payload.h"
+#include "logbuf.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+static const char *TAG = "TELEMQ";
+
+#define TELEMQ_SECTOR_SIZE 4096
+#define TELEMQ_REC_LEN 32
+#define TELEMQ_REC_VERSION 2
+#define TELEMQ_RECS_PER_SECTOR (TELEMQ_SECTOR_SIZE / TELEMQ_REC_LEN)
+#define TELEMQ_SEQ_ERASED 0xFFFFFFFFu
+#define TELEMQ_PENDING 0xFF
+#define TELEMQ_SENT 0x00
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;       // sequência monotônica da fila (0xFFFFFFFF = slot apagado)
+    uint32_t ts_ms;     // instante da captura (uptime do boot de origem)
+    uint32_t pub_seq;   // sequência de publicação da amostra (sample_t.seq)
+    uint64_t epoch_ms;  // captura em epoch (0 = sem SNTP)
+    uint16_t boot;      // boot de origem
+    int16_t temp;       // temp_c * 100
+    uint16_t hum;       // hum * 100
+    uint8_t rain;       // rain_pct
+    uint8_t flags;      // PAYLOAD_BIN_FLAG_*
+    uint8_t reserved;
+    uint8_t version;    // TELEMQ_REC_VERSION; no formato antigo de 16 B este
+                        // byte cai nas flags (0/1), então nunca é aceito
+    uint8_t crc;        // CRC-8 dos 30 bytes anteriores
+    uint8_t sent;       // 0xFF pendente, 0x00 enviado (gravado sem apagar)
+} telemq_rec_t;
+
+static_assert(sizeof(telemq_rec_t) == TELEMQ_REC_LEN, "registro deve ter 32 bytes");
+
+static const esp_partition_t *s_part = nullptr;
+static uint32_t s_slots = 0;    // registros na partição
+static uint32_t s_head = 0;     // próximo slot a gravar
+static uint32_t s_tail = 0;     // slot da pendência mais antiga
+static uint32_t s_next_seq = 1;
+
+// Apenas a task publicadora altera a fila; os contadores são lidos pelo httpd
+static std::atomic<uint32_t> s_depth{0};
+static std::atomic<uint32_t> s_stored{0};
+static std::atomic<uint32_t> s_replayed{0};
+static std::atomic<uint32_t> s_dropped{0};
+static std::atomic<bool> s_replaying{false};
+
+static uint8_t crc8(const uint8_t *p, size_t n)
+{
+    uint8_t crc = 0;
+    while (n--)
+    {
+        crc ^= *p++;
+        for (int i = 0; i < 8; ++i)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static bool rec_valid(const telemq_rec_t *r)
+{
+    return r->seq != TELEMQ_SEQ_ERASED && r->version == TELEMQ_REC_VERSION && r->crc == crc8((const uint8_t *)r, offsetof(telemq_rec_t, crc));
+}
+
+static bool rec_read(uint32_t slot, telemq_rec_t *r)
+{
+    return esp_partition_read(s_part, (size_t)slot * TELEMQ_REC_LEN, r, sizeof(*r)) == ESP_OK;
+}
+
+bool telemq_init(void)
+{
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)TELEMQ_PARTITION_SUBTYPE,
+                                      TELEMQ_PARTITION_LABEL);
+    if (!s_part)
+    {
+        ESP_LOGW(TAG, "Particao '%s' nao encontrada; store-and-forward desativado", TELEMQ_PARTITION_LABEL);
+        logbuf_add(LOG_LVL_WARN, TAG, "Particao telemq ausente");
+        return false;
+    }
+    s_slots = (s_part->size / TELEMQ_SECTOR_SIZE) * TELEMQ_RECS_PER_SECTOR;
+
+    // 1. Localiza o registro mais recente (maior seq) para posicionar a escrita
+    uint32_t max_seq = 0;
+    uint32_t max_slot = 0;
+    bool any = false;
+    telemq_rec_t chunk[16];
+    for (uint32_t slot = 0; slot < s_slots; slot += 16)
+    {
+        if (esp_partition_read(s_part, (size_t)slot * TELEMQ_REC_LEN, chunk, sizeof(chunk)) != ESP_OK)
+            break;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            if (rec_valid(&chunk[i]) && (!any || chunk[i].seq > max_seq))
+            {
+                max_seq = chunk[i].seq;
+                max_slot = slot + i;
+                any = true;
+            }
+        }
+    }
+
+    if (!any)
+    {
+        s_head = 0;
+        s_tail = 0;
+        s_next_seq = 1;
+        ESP_LOGI(TAG, "Fila vazia (%lu registros)", (unsigned long)s_slots);
+        return true;
+    }
+
+    s_head = (max_slot + 1) % s_slots;
+    s_next_seq = max_seq + 1;
+
+    // 2. Pendências formam um trecho contíguo terminando no último registro:
+    // volta enquanto a sequência for consecutiva e o registro não estiver enviado
+    uint32_t depth = 0;
+    uint32_t slot = max_slot;
+    uint32_t expect = max_seq;
+    telemq_rec_t r;
+    while (depth < s_slots && rec_read(slot, &r) && rec_valid(&r) && r.seq == expect && r.sent == TELEMQ_PENDING)
+    {
+        depth++;
+        expect--;
+        slot = (slot + s_slots - 1) % s_slots;
+    }
+    s_tail = (s_head + s_slots - depth) % s_slots;
+    s_depth.store(depth, std::memory_order_relaxed);
+
+    ESP_LOGI(TAG, "Recuperadas %lu amostras pendentes (seq %lu)", (unsigned long)depth, (unsigned long)max_seq);
+    if (depth > 0)
+        logbuf_add_num(LOG_LVL_INFO, TAG, "%d amostras pendentes recuperadas da flash", (int16_t)depth);
+    return true;
+}
+
+bool telemq_push(const sample_t *s)
+{
+    if (!s_part || !s)
+        return false;
+
+    uint32_t depth = s_depth.load(std::memory_order_relaxed);
+
+    // Entrando em um novo setor: apaga-o antes da primeira gravação.
+    // Pendências que ainda estejam nele são descartadas (as mais antigas).
+    if (s_head % TELEMQ_RECS_PER_SECTOR == 0)
+    {
+        uint32_t sector_end = s_head + TELEMQ_RECS_PER_SECTOR;
+        while (depth > 0 && s_tail >= s_head && s_tail < sector_end)
+        {
+            s_tail = (s_tail + 1) % s_slots;
+            depth--;
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (esp_partition_erase_range(s_part, (size_t)s_head * TELEMQ_REC_LEN, TELEMQ_SECTOR_SIZE) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Falha ao apagar setor");
+            s_depth.store(depth, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    telemq_rec_t r;
+    r.seq = s_next_seq;
+    r.ts_ms = (uint32_t)(s->ts_us / 1000);
+    r.pub_seq = s->seq;
+    r.epoch_ms = s->epoch_ms;
+    r.boot = s->boot;
+    r.temp = payload_temp_to_fixed(s->temp);
+    r.hum = payload_hum_to_fixed(s->hum);
+    r.rain = (uint8_t)(s->rain_pct < 0 ? 0 : s->rain_pct > 100 ? 100 : s->rain_pct);
+    r.flags = s->dht_ok ? PAYLOAD_BIN_FLAG_DHT_OK : 0;
+    r.version = TELEMQ_REC_VERSION;
+    r.reserved = 0xFF;
+    r.crc = crc8((const uint8_t *)&r, offsetof(telemq_rec_t, crc));
+    r.sent = TELEMQ_PENDING;
+
+    if (esp_partition_write(s_part, (size_t)s_head * TELEMQ_REC_LEN, &r, sizeof(r)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao gravar registro");
+        s_depth.store(depth, std::memory_order_relaxed);
+        return false;
+    }
+
+    s_next_seq++;
+    s_head = (s_head + 1) % s_slots;
+    s_depth.store(depth + 1, std::memory_order_relaxed);
+    s_stored.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Registro corrompido após a recuperação (gravação interrompida, bit
+// invertido): marca como enviado e avança a cauda para não travar a fila
+static void skip_corrupt_tail(uint32_t *depth)
+{
+    const uint8_t sent = TELEMQ_SENT;
+    ESP_LOGW(TAG, "Registro corrompido descartado (slot %lu)", (unsigned long)s_tail);
+    esp_partition_write(s_part, (size_t)s_tail * TELEMQ_REC_LEN + offsetof(telemq_rec_t, sent), &sent, 1);
+    s_tail = (s_tail + 1) % s_slots;
+    (*depth)--;
+    s_depth.store(*depth, std::memory_order_relaxed);
+    s_dropped.fetch_add(1, std::memory_order_relaxed);
+    logbuf_add(LOG_LVL_WARN, TAG, "Registro corrompido na fila descartado");
+}
+
+int telemq_peek(sample_t *out, int max)
+{
+    if (!s_part || !out)
+        return 0;
+    uint32_t depth = s_depth.load(std::memory_order_relaxed);
+    int n = 0;
+    uint32_t slot = s_tail;
+    telemq_rec_t r;
+    while (n < max && (uint32_t)n < depth && rec_read(slot, &r))
+    {
+        if (!rec_valid(&r))
+        {
+            // Na cauda: descarta e continua. No meio do lote: entrega só o
+            // trecho válido; o registro ruim vira cauda após o ack
+            if (n > 0)
+                break;
+            skip_corrupt_tail(&depth);
+            slot = s_tail;
+            continue;
+        }
+        sample_t *s = &out[n++];
+        s->ts_us = (int64_t)r.ts_ms * 1000;
+        s->temp = payload_temp_from_fixed(r.temp);
+        s->hum = payload_hum_from_fixed(r.hum);
+        s->rain_pct = r.rain;
+        s->dht_ok = (r.flags & PAYLOAD_BIN_FLAG_DHT_OK) != 0;
+        s->seq = r.pub_seq;
+        s->boot = r.boot;
+        s->epoch_ms = r.epoch_ms;
+        slot = (slot + 1) % s_slots;
+    }
+    return n;
+}
+
+void telemq_ack(int n)
+{
+    if (!s_part)
+        return;
+    uint32_t depth = s_depth.load(std::memory_order_relaxed);
+    const uint8_t sent = TELEMQ_SENT;
+    while (n-- > 0 && depth > 0)
+    {
+        esp_partition_write(s_part, (size_t)s_tail * TELEMQ_REC_LEN + offsetof(telemq_rec_t, sent), &sent, 1);
+        s_tail = (s_tail + 1) % s_slots;
+        depth--;
+        s_replayed.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_depth.store(depth, std::memory_order_relaxed);
+    if (depth == 0 && s_replaying.exchange(false))
+        logbuf_add(LOG_LVL_INFO, TAG, "Reenvio da fila em flash concluido");
+}
+
+uint32_t telemq_depth(void)
+{
+    return s_depth.load(std::memory_order_relaxed);
+}
+
+void telemq_on_connected(void)
+{
+    if (s_depth.load(std::memory_order_relaxed) > 0)
+    {
+        s_replaying.store(true);
+        logbuf_add(LOG_LVL_INFO, TAG, "Reenviando amostras armazenadas em flash");
+    }
+}
+
+telemq_stats_t telemq_get_stats(void)
+{
+    telemq_stats_t st = {};
+    st.depth = s_depth.load(std::memory_order_relaxed);
+    st.capacity = s_slots;
+    st.stored = s_stored.load(std::memory_order_relaxed);
+    st.replayed = s_replayed.load(std::memory_order_relaxed);
+    st.dropped = s_dropped.load(std::memory_order_relaxed);
+    st.replaying = s_replaying.load(std::memory_order_relaxed);
+    return st;
+}
@@ -0,0 +1,47 @@
+#ifndef TELEMQ_H
+#define TELEMQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sampler.h"
+
+// Fila store-and-forward de telemetria na partição "telemq".
+// Registros de tamanho fixo são gravados em modo append circular; cada
+// setor só é apagado quando a escrita volta a ele (desgaste uniforme) e
+// o envio é marcado regravando um único byte (1 -> 0), sem apagar.
+
+#define TELEMQ_PARTITION_LABEL "telemq"
+#define TELEMQ_PARTITION_SUBTYPE 0x40
+#define TELEMQ_REPLAY_BURST 8         // amostras por lote reenviado
+#define TELEMQ_REPLAY_INTERVAL_MS 1000 // intervalo mínimo entre lotes reenviados
+
+typedef struct {
+    uint32_t depth;    // amostras pendentes
+    uint32_t capacity; // total de registros na partição
+    uint32_t stored;   // amostras gravadas desde o boot
+    uint32_t replayed; // amostras reenviadas desde o boot
+    uint32_t dropped;  // pendentes sobrescritas com a fila cheia ou corrompidas
+    bool replaying;    // reenvio em andamento (broker conectado com pendências)
+} telemq_stats_t;
+
+// Localiza a partição e recupera as pendências gravadas antes do reset
+bool telemq_init(void);
+
+// Grava uma amostra não enviada (descarta a mais antiga se cheia)
+bool telemq_push(const sample_t *s);
+
+// Copia até 'max' amostras pendentes mais antigas, sem removê-las.
+// Registros com CRC inválido na cauda são descartados (contam em dropped)
+int telemq_peek(sample_t *out, int max);
+
+// Marca as 'n' amostras mais antigas como enviadas
+void telemq_ack(int n);
+
+uint32_t telemq_depth(void);
+
+// Chamado em MQTT_EVENT_CONNECTED para iniciar o reenvio
+void telemq_on_connected(void);
+
+telemq_stats_t telemq_get_stats(void);
+
+#endif // TELEMQ_H
@@ -0,0 +1,71 @@
+#include "timesync.h"
+#include "logbuf.h"
+#include "esp_log.h"
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include <sys/time.h>
+#include <atomic>
+
+static const char *TAG = "TIMESYNC";
+
+static uint16_t s_boot_id = 0;
+// epoch_ms - uptime_ms, recalculado a cada sincronização (0 = nunca)
+static std::atomic<int64_t> s_offset_ms{0};
+
+void timesync_init(void)
+{
+    nvs_handle_t h;
+    if (nvs_open("timesync", NVS_READWRITE, &h) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "NVS indisponivel; boot id 0");
+        return;
+    }
+    uint16_t boot = 0;
+    nvs_get_u16(h, "boot", &boot);
+    s_boot_id = (uint16_t)(boot + 1);
+    nvs_set_u16(h, "boot", s_boot_id);
+    nvs_commit(h);
+    nvs_close(h);
+    ESP_LOGI(TAG, "Boot #%u", (unsigned)s_boot_id);
+}
+
+static void on_sync(struct timeval *tv)
+{
+    int64_t epoch_ms = (int64_t)tv->tv_sec * 1000 + tv->tv_usec / 1000;
+    bool first = s_offset_ms.load(std::memory_order_relaxed) == 0;
+    s_offset_ms.store(epoch_ms - esp_timer_get_time() / 1000, std::memory_order_relaxed);
+    if (first)
+    {
+        ESP_LOGI(TAG, "Relogio sincronizado via SNTP");
+        logbuf_add(LOG_LVL_INFO, TAG, "Relogio sincronizado (SNTP)");
+    }
+}
+
+void timesync_start(void)
+{
+    if (esp_sntp_enabled())
+        return;
+    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    esp_sntp_setservername(0, TIMESYNC_SERVER);
+    sntp_set_time_sync_notification_cb(on_sync);
+    esp_sntp_init();
+}
+
+uint16_t timesync_boot_id(void)
+{
+    return s_boot_id;
+}
+
+bool timesync_synced(void)
+{
+    return s_offset_ms.load(std::memory_order_relaxed) != 0;
+}
+
+uint64_t timesync_epoch_ms(int64_t uptime_us)
+{
+    int64_t offset = s_offset_ms.load(std::memory_order_relaxed);
+    if (offset == 0)
+        return 0;
+    return (uint64_t)(offset + uptime_us / 1000);
+}
@@ -0,0 +1,26 @@
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Relógio de parede (SNTP) e identificação do boot, usados para carimbar a
+// telemetria. Sem sincronização, as amostras levam apenas o uptime; o
+// contador de boots (NVS) permite ao assinante reiniciar a sequência.
+
+#define TIMESYNC_SERVER "pool.ntp.org"
+
+// Incrementa o contador de boots na NVS (chamar após nvs_flash_init)
+void timesync_init(void);
+
+// Inicia o SNTP em modo poll (chamar com STA conectado)
+void timesync_start(void);
+
+uint16_t timesync_boot_id(void);
+bool timesync_synced(void);
+
+// Converte um instante de uptime (us) deste boot em epoch (ms).
+// Retorna 0 enquanto o relógio não foi sincronizado.
+uint64_t timesync_epoch_ms(int64_t uptime_us);
+
+#endif // TIMESYNC_H
@@ -0,0 +1,169 @@
+#include "web_assets.h"
+#include "logbuf.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <string.h>
+
+static const char *TAG = "ASSETS";
+
+// Formato da imagem: ver tools/embed_web_assets.py
+#define IMAGE_MAGIC "WAI1"
+#define IMAGE_VERSION 1
+#define IMAGE_FLAG_IMMUTABLE 0x01
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version;
+    uint16_t count;
+    uint32_t total_len;
+    uint32_t reserved;
+} image_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t path_off;
+    uint32_t mime_off;
+    uint32_t etag_off;
+    uint32_t data_off;
+    uint32_t data_len;
+    uint32_t flags;
+    uint32_t reserved[2];
+} image_entry_t;
+
+static const uint8_t *s_image = nullptr; // imagem mapeada (nullptr = usa a tabela embutida)
+static const image_entry_t *s_entries = nullptr;
+static uint16_t s_count = 0;
+static esp_partition_mmap_handle_t s_mmap;
+
+// Compara 'path' (não terminado em '\0') com uma string C
+static int path_cmp(const char *path, size_t len, const char *s)
+{
+    int c = strncmp(path, s, len);
+    if (c != 0)
+        return c;
+    return s[len] == '\0' ? 0 : -1;
+}
+
+// String terminada em '\0' dentro dos limites da imagem
+static bool str_ok(uint32_t off, uint32_t total)
+{
+    return off < total && memchr(s_image + off, '\0', total - off) != nullptr;
+}
+
+// Valida o índice uma única vez no boot; depois as buscas confiam nos offsets
+static bool image_valid(uint32_t total)
+{
+    const char *prev = nullptr;
+    for (uint16_t i = 0; i < s_count; ++i)
+    {
+        const image_entry_t *e = &s_entries[i];
+        if (!str_ok(e->path_off, total) || !str_ok(e->mime_off, total) || !str_ok(e->etag_off, total))
+            return false;
+        if (e->data_off > total || e->data_len > total - e->data_off)
+            return false;
+        const char *path = (const char *)s_image + e->path_off;
+        if (prev && strcmp(prev, path) >= 0) // precisa estar ordenada
+            return false;
+        prev = path;
+    }
+    return true;
+}
+
+void web_assets_init(void)
+{
+    const esp_partition_t *part =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    if (!part)
+    {
+        ESP_LOGW(TAG, "Partição 'storage' não encontrada; usando assets embutidos");
+        return;
+    }
+
+    image_header_t hdr;
+    if (esp_partition_read(part, 0, &hdr, sizeof(hdr)) != ESP_OK || memcmp(hdr.magic, IMAGE_MAGIC, 4) != 0 ||
+        hdr.version != IMAGE_VERSION || hdr.total_len > part->size ||
+        hdr.total_len < sizeof(hdr) + (uint32_t)hdr.count * sizeof(image_entry_t))
+    {
+        ESP_LOGW(TAG, "Imagem de assets ausente ou inválida; usando assets embutidos");
+        logbuf_add(LOG_LVL_WARN, TAG, "Imagem de assets invalida; usando embutidos");
+        return;
+    }
+
+    const void *ptr = nullptr;
+    esp_err_t err = esp_partition_mmap(part, 0, hdr.total_len, ESP_PARTITION_MMAP_DATA, &ptr, &s_mmap);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao mapear a partição (%s)", esp_err_to_name(err));
+        return;
+    }
+    s_image = (const uint8_t *)ptr;
+    s_entries = (const image_entry_t *)(s_image + sizeof(image_header_t));
+    s_count = hdr.count;
+
+    if (!image_valid(hdr.total_len))
+    {
+        ESP_LOGE(TAG, "Índice da imagem de assets corrompido; usando assets embutidos");
+        logbuf_add(LOG_LVL_ERROR, TAG, "Indice de assets corrompido");
+        esp_partition_munmap(s_mmap);
+        s_image = nullptr;
+        s_entries = nullptr;
+        s_count = 0;
+        return;
+    }
+    ESP_LOGI(TAG, "Imagem de assets mapeada: %u arquivos, %u bytes", (unsigned)s_count, (unsigned)hdr.total_len);
+    logbuf_add(LOG_LVL_INFO, TAG, "Imagem de assets mapeada");
+}
+
+static bool find_image(const char *path, size_t len, web_asset_t *out)
+{
+    size_t lo = 0;
+    size_t hi = s_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        const image_entry_t *e = &s_entries[mid];
+        int c = path_cmp(path, len, (const char *)s_image + e->path_off);
+        if (c == 0)
+        {
+            out->path = (const char *)s_image + e->path_off;
+            out->mime = (const char *)s_image + e->mime_off;
+            out->gz = s_image + e->data_off;
+            out->gz_len = e->data_len;
+            out->etag = (const char *)s_image + e->etag_off;
+            out->immutable = (e->flags & IMAGE_FLAG_IMMUTABLE) != 0;
+            return true;
+        }
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return false;
+}
+
+static bool find_embedded(const char *path, size_t len, web_asset_t *out)
+{
+    size_t lo = 0;
+    size_t hi = g_web_assets_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = path_cmp(path, len, g_web_assets[mid].path);
+        if (c == 0)
+        {
+            *out = g_web_assets[mid];
+            return true;
+        }
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return false;
+}
+
+bool web_assets_find(const char *path, size_t len, web_asset_t *out)
+{
+    if (s_image)
+        return find_image(path, len, out);
+    return find_embedded(path, len, out);
+}
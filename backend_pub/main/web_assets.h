@@ -0,0 +1,33 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Arquivos de web/ comprimidos (gzip) em tempo de build
+// (tools/embed_web_assets.py). A fonte principal é a imagem gravada na
+// partição 'storage' e mapeada em memória no boot; a tabela embutida no
+// firmware é usada quando a partição não tem uma imagem válida. As duas
+// são ordenadas por caminho.
+
+typedef struct {
+    const char *path;   // ex.: "/index.html"
+    const char *mime;
+    const uint8_t *gz;  // conteúdo gzip
+    uint32_t gz_len;
+    const char *etag;   // ETag forte (hash do conteúdo), já com aspas
+    bool immutable;     // referenciado com ?v=<hash>: pode ficar em cache
+} web_asset_t;
+
+extern const web_asset_t g_web_assets[];
+extern const size_t g_web_assets_count;
+
+// Mapeia a imagem da partição 'storage' (sem sistema de arquivos)
+void web_assets_init(void);
+
+// Busca binária pelo caminho (len bytes de 'path', sem query string).
+// Os ponteiros de 'out' apontam para a flash e valem até o reboot.
+bool web_assets_find(const char *path, size_t len, web_asset_t *out);
+
+#endif // WEB_ASSETS_H
@@ -1,84 +1,81 @@
 #include "webserver.h"
 #include "esp_log.h"
 #include "esp_timer.h"
-#include "esp_netif.h"
-#include "esp_spiffs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "wifi.h"
-#include "mqtt.h"
 #include "status.h"
+#include "sampler.h"
+#include "telemq.h"
+#include "deadband.h"
+#include "history.h"
 #include "logbuf.h"
+#include "logstore.h"
+#include "sse.h"
+#include "metrics.h"
+#include "web_assets.h"
 #include "config.h"
+#include "alert.h"
 #include "cJSON.h"
 #include <string.h>
-#include <string>
 #include <stdio.h>
 #include <stdlib.h>
 
 static const char *TAG = "WEB";
 
-// Servidor de arquivos: lê de /spiffs conforme URI
-static esp_err_t file_handler(httpd_req_t *req)
+// Asset: gzip + ETag forte; 304 quando o cliente já tem a versão.
+// CSS/JS são referenciados com ?v=<hash> e podem ficar em cache indefinidamente.
+static esp_err_t send_asset(httpd_req_t *req, const web_asset_t *a)
 {
-    std::string path = "/spiffs";
-    if (strcmp(req->uri, "/") == 0)
-        path += "/index.html";
-    else
-        path += req->uri;
+    httpd_resp_set_hdr(req, "ETag", a->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", a->immutable ? "public, max-age=31536000, immutable" : "no-cache");
 
-    FILE *fd = fopen(path.c_str(), "r");
-    if (!fd)
+    char inm[48];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK && strstr(inm, a->etag))
     {
-        httpd_resp_send_404(req);
-        return ESP_FAIL;
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
 
-    // MIME Types básicos
-    if (path.find(".css") != std::string::npos)
-        httpd_resp_set_type(req, "text/css");
-    else if (path.find(".js") != std::string::npos)
-        httpd_resp_set_type(req, "application/javascript");
-    else
-        httpd_resp_set_type(req, "text/html");
+    httpd_resp_set_type(req, a->mime);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)a->gz, a->gz_len);
+}
 
-    char chunk[1024];
-    size_t chunksize;
-    while ((chunksize = fread(chunk, 1, sizeof(chunk), fd)) > 0)
+// Servidor de arquivos: busca no índice de assets e envia direto da flash
+// mapeada, sem abrir arquivo
+static esp_err_t file_handler(httpd_req_t *req)
+{
+    metrics_http(HTTP_EP_FILES);
+    size_t uri_len = strcspn(req->uri, "?");
+    web_asset_t asset;
+    bool found = (uri_len == 1 && req->uri[0] == '/') ? web_assets_find("/index.html", 11, &asset)
+                                                     : web_assets_find(req->uri, uri_len, &asset);
+    if (!found)
     {
-        httpd_resp_send_chunk(req, chunk, chunksize);
+        httpd_resp_send_404(req);
+        return ESP_FAIL;
     }
-    httpd_resp_send_chunk(req, NULL, 0);
-    fclose(fd);
-    return ESP_OK;
+    return send_asset(req, &asset);
 }
 
-static esp_err_t status_handler(httpd_req_t *req)
+// Snapshot do /status já serializado. É reconstruído quando o estado muda
+// (status_version) ou quando fica velho, já que uptime e contadores andam
+// sozinhos; requisições simultâneas esperam a mesma reconstrução.
+#define STATUS_SNAPSHOT_MAX_MS 1000
+#define STATUS_JSON_MAX 1024
+
+static SemaphoreHandle_t s_status_lock = nullptr;
+static char s_status_buf[STATUS_JSON_MAX];
+static int s_status_len = 0;
+static uint32_t s_status_seen = 0;      // status_version() do último build
+static uint32_t s_status_version = 0;   // versão do snapshot (campo "version")
+static int64_t s_status_built_us = 0;
+
+// Monta o JSON de status a partir do estado em cache (sem chamar o driver)
+static int status_json(char *json, size_t size, uint32_t version)
 {
-    bool wifi_ok = wifi_is_connected();
-    bool mqtt_ok = mqtt_is_connected();
-
-    char ip_str[16] = "0.0.0.0";
-    char gw_str[16] = "0.0.0.0";
-    int rssi = -127; // valor padrão quando indisponível
-    const char *mode = wifi_mode_is_ap() ? "AP" : "STA";
-    esp_netif_t *netif = wifi_get_netif();
-    if (netif)
-    {
-        esp_netif_ip_info_t ip_info;
-        if (esp_netif_get_ip_info(netif, &ip_info) == ESP_OK)
-        {
-            snprintf(ip_str, sizeof(ip_str), "%d.%d.%d.%d", IP2STR(&ip_info.ip));
-            snprintf(gw_str, sizeof(gw_str), "%d.%d.%d.%d", IP2STR(&ip_info.gw));
-        }
-    }
-    // RSSI somente em modo STA
-    if (!wifi_mode_is_ap())
-    {
-        wifi_ap_record_t ap;
-        if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK)
-        {
-            rssi = ap.rssi; // dBm
-        }
-    }
+    net_status_t net = status_get_net();
 
     int64_t us = esp_timer_get_time();
     int64_t secs = us / 1000000LL;
@@ -91,32 +88,127 @@ static esp_err_t status_handler(httpd_req_t *req)
 
     telemetry_t t = status_get_telemetry();
 
+    sampler_stats_t ss = sampler_get_stats();
+    telemq_stats_t qs = telemq_get_stats();
+    deadband_stats_t ds = deadband_get_stats();
+
     uint32_t uptime_ms = (uint32_t)(us / 1000ULL);
 
-    char json[400];
-    int len = snprintf(json, sizeof(json),
-                       "{\"wifi_connected\":%s,\"mode\":\"%s\",\"ip\":\"%s\",\"gw\":\"%s\",\"rssi\":%d,\"mqtt_connected\":%s,\"uptime\":\"%dd %dh %dm %ds\",\"uptime_ms\":%lu,\"temp\":%.2f,\"hum\":%.2f,\"rain_pct\":%d}",
-                       wifi_ok ? "true" : "false", mode, ip_str, gw_str, rssi, mqtt_ok ? "true" : "false",
+    sse_stats_t es = sse_get_stats();
+
+    return snprintf(json, size,
+                       "{\"version\":%lu,\"wifi_connected\":%s,\"mode\":\"%s\",\"ip\":\"%s\",\"gw\":\"%s\",\"rssi\":%d,\"mqtt_connected\":%s,\"uptime\":\"%dd %dh %dm %ds\",\"uptime_ms\":%lu,\"temp\":%.2f,\"hum\":%.2f,\"rain_pct\":%d,"
+                       "\"sampler\":{\"produced\":%lu,\"dropped\":%lu,\"depth\":%lu,\"max_depth\":%lu,\"jitter_us\":%ld,\"jitter_max_us\":%ld},"
+                       "\"flash_queue\":{\"depth\":%lu,\"capacity\":%lu,\"stored\":%lu,\"replayed\":%lu,\"dropped\":%lu,\"replaying\":%s},"
+                       "\"deadband\":{\"enabled\":%s,\"evaluated\":%lu,\"published\":%lu,\"suppressed\":%lu,\"heartbeats\":%lu,\"suppression_ratio\":%.3f},"
+                       "\"sse\":{\"clients\":%lu,\"published\":%lu,\"sent\":%lu,\"dropped\":%lu}}",
+                       (unsigned long)version, net.wifi_connected ? "true" : "false", net.ap_mode ? "AP" : "STA",
+                       net.ip, net.gw, net.rssi, net.mqtt_connected ? "true" : "false",
                        days, hours, mins, s, (unsigned long)uptime_ms,
-                       t.temp, t.hum, t.rain_pct);
+                       t.temp, t.hum, t.rain_pct,
+                       (unsigned long)ss.produced, (unsigned long)ss.dropped, (unsigned long)ss.depth,
+                       (unsigned long)ss.max_depth, (long)ss.jitter_last_us, (long)ss.jitter_max_us,
+                       (unsigned long)qs.depth, (unsigned long)qs.capacity, (unsigned long)qs.stored,
+                       (unsigned long)qs.replayed, (unsigned long)qs.dropped, qs.replaying ? "true" : "false",
+                       ds.enabled ? "true" : "false", (unsigned long)ds.evaluated, (unsigned long)ds.published,
+                       (unsigned long)ds.suppressed, (unsigned long)ds.heartbeats,
+                       ds.evaluated ? (double)ds.suppressed / ds.evaluated : 0.0,
+                       (unsigned long)es.clients, (unsigned long)es.published, (unsigned long)es.sent,
+                       (unsigned long)es.dropped);
+}
+
+// Copia o snapshot para 'out' (reconstrói antes, se necessário)
+static int status_snapshot(char *out, size_t size)
+{
+    if (!s_status_lock)
+        return 0;
+    xSemaphoreTake(s_status_lock, portMAX_DELAY);
+    uint32_t ver = status_version();
+    int64_t now = esp_timer_get_time();
+    if (s_status_len <= 0 || ver != s_status_seen ||
+        now - s_status_built_us >= (int64_t)STATUS_SNAPSHOT_MAX_MS * 1000)
+    {
+        int n = status_json(s_status_buf, sizeof(s_status_buf), s_status_version + 1);
+        if (n > 0 && n < (int)sizeof(s_status_buf))
+        {
+            s_status_len = n;
+            s_status_version++;
+        }
+        s_status_seen = ver;
+        s_status_built_us = now;
+    }
+    int len = s_status_len < (int)size ? s_status_len : 0;
+    memcpy(out, s_status_buf, (size_t)len);
+    xSemaphoreGive(s_status_lock);
+    return len;
+}
+
+static esp_err_t status_handler(httpd_req_t *req)
+{
+    metrics_http(HTTP_EP_STATUS);
+    char json[STATUS_JSON_MAX];
+    int len = status_snapshot(json, sizeof(json));
     httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
     return httpd_resp_send(req, json, len);
 }
 
+void webserver_push_status(void)
+{
+    if (sse_client_count() == 0)
+        return;
+    char json[STATUS_JSON_MAX + 1];
+    int len = status_snapshot(json, sizeof(json) - 1);
+    if (len > 0)
+    {
+        json[len] = '\0';
+        sse_publish("telemetry", json);
+    }
+}
+
 // --- Config API ---
 static esp_err_t config_get_handler(httpd_req_t *req)
 {
+    metrics_http(HTTP_EP_CONFIG);
     const app_config_t *cfg = config_get();
-    char json[768];
+    char json[1024];
     int len = snprintf(json, sizeof(json),
-                       "{\"ssid\":\"%s\",\"pass\":\"%s\",\"broker\":\"%s\",\"port\":%d,\"topic\":\"%s\",\"qos\":%d,\"user\":\"%s\",\"pass_mqtt\":\"%s\"}",
-                       cfg->ssid, cfg->pass, cfg->broker, cfg->port, cfg->topic, cfg->qos, cfg->user, cfg->pass_mqtt);
+                       "{\"ssid\":\"%s\",\"pass\":\"%s\",\"broker\":\"%s\",\"port\":%d,\"topic\":\"%s\",\"qos\":%d,\"user\":\"%s\",\"pass_mqtt\":\"%s\","
+                       "\"batch_size\":%d,\"batch_max_s\":%d,\"payload_fmt\":%d,"
+                       "\"rbe_enabled\":%s,\"db_temp\":%.2f,\"db_hum\":%.2f,\"db_rain\":%d,\"heartbeat_s\":%d,"
+                       "\"alert_temp_mid\":%.1f,\"alert_temp_high\":%.1f,\"alert_rain_mid\":%.0f,\"alert_rain_heavy\":%.0f}",
+                       cfg->ssid, cfg->pass, cfg->broker, cfg->port, cfg->topic, cfg->qos, cfg->user, cfg->pass_mqtt,
+                       cfg->batch_size, cfg->batch_max_s, cfg->payload_fmt,
+                       cfg->rbe_enabled ? "true" : "false", cfg->db_temp, cfg->db_hum, cfg->db_rain, cfg->heartbeat_s,
+                       cfg->alert.temp_mid, cfg->alert.temp_high, cfg->alert.rain_mid, cfg->alert.rain_heavy);
     httpd_resp_set_type(req, "application/json");
     return httpd_resp_send(req, json, len);
 }
 
+// Campos numéricos podem chegar como número ou string (valores de <input>)
+static int json_get_int(const cJSON *root, const char *key, int def)
+{
+    cJSON *item = cJSON_GetObjectItem(root, key);
+    if (item && cJSON_IsNumber(item))
+        return item->valueint;
+    if (item && cJSON_IsString(item) && item->valuestring[0])
+        return atoi(item->valuestring);
+    return def;
+}
+
+static float json_get_float(const cJSON *root, const char *key, float def)
+{
+    cJSON *item = cJSON_GetObjectItem(root, key);
+    if (item && cJSON_IsNumber(item))
+        return (float)item->valuedouble;
+    if (item && cJSON_IsString(item) && item->valuestring[0])
+        return strtof(item->valuestring, NULL);
+    return def;
+}
+
 static esp_err_t config_post_handler(httpd_req_t *req)
 {
+    metrics_http(HTTP_EP_CONFIG);
     int total = req->content_len;
     if (total <= 0 || total > 2048)
     {
@@ -154,13 +246,12 @@ static esp_err_t config_post_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    app_config_t cfg = {};
+    // Parte da configuração atual: só as chaves presentes no corpo mudam
+    app_config_t cfg = *config_get();
     cJSON *ssid = cJSON_GetObjectItem(root, "ssid");
     cJSON *pass = cJSON_GetObjectItem(root, "pass");
     cJSON *broker = cJSON_GetObjectItem(root, "broker");
-    cJSON *port = cJSON_GetObjectItem(root, "port");
     cJSON *topic = cJSON_GetObjectItem(root, "topic");
-    cJSON *qos = cJSON_GetObjectItem(root, "qos");
     cJSON *user = cJSON_GetObjectItem(root, "user");
     cJSON *pass_mqtt = cJSON_GetObjectItem(root, "pass_mqtt");
 
@@ -170,20 +261,28 @@ static esp_err_t config_post_handler(httpd_req_t *req)
         strlcpy(cfg.pass, pass->valuestring, sizeof(cfg.pass));
     if (broker && cJSON_IsString(broker))
         strlcpy(cfg.broker, broker->valuestring, sizeof(cfg.broker));
-    if (port && cJSON_IsNumber(port))
-        cfg.port = port->valueint;
-    else
-        cfg.port = 1883;
+    cfg.port = json_get_int(root, "port", cfg.port);
     if (topic && cJSON_IsString(topic))
         strlcpy(cfg.topic, topic->valuestring, sizeof(cfg.topic));
-    if (qos && cJSON_IsNumber(qos))
-        cfg.qos = qos->valueint;
-    else
-        cfg.qos = 0;
+    cfg.qos = json_get_int(root, "qos", cfg.qos);
     if (user && cJSON_IsString(user))
         strlcpy(cfg.user, user->valuestring, sizeof(cfg.user));
     if (pass_mqtt && cJSON_IsString(pass_mqtt))
         strlcpy(cfg.pass_mqtt, pass_mqtt->valuestring, sizeof(cfg.pass_mqtt));
+    cfg.batch_size = json_get_int(root, "batch_size", cfg.batch_size);
+    cfg.batch_max_s = json_get_int(root, "batch_max_s", cfg.batch_max_s);
+    cfg.payload_fmt = json_get_int(root, "payload_fmt", cfg.payload_fmt);
+    cJSON *rbe = cJSON_GetObjectItem(root, "rbe_enabled");
+    cfg.rbe_enabled = cJSON_IsBool(rbe) ? (cJSON_IsTrue(rbe) ? 1 : 0) : json_get_int(root, "rbe_enabled", cfg.rbe_enabled);
+    cfg.db_temp = json_get_float(root, "db_temp", cfg.db_temp);
+    cfg.db_hum = json_get_float(root, "db_hum", cfg.db_hum);
+    cfg.db_rain = json_get_int(root, "db_rain", cfg.db_rain);
+    cfg.heartbeat_s = json_get_int(root, "heartbeat_s", cfg.heartbeat_s);
+    cfg.alert.temp_mid = json_get_float(root, "alert_temp_mid", cfg.alert.temp_mid);
+    cfg.alert.temp_high = json_get_float(root, "alert_temp_high", cfg.alert.temp_high);
+    cfg.alert.rain_mid = json_get_float(root, "alert_rain_mid", cfg.alert.rain_mid);
+    cfg.alert.rain_heavy = json_get_float(root, "alert_rain_heavy", cfg.alert.rain_heavy);
+    alert_thresholds_sanitize(&cfg.alert);
 
     cJSON_Delete(root);
 
@@ -210,6 +309,7 @@ static esp_err_t config_post_handler(httpd_req_t *req)
 
 static esp_err_t config_clear_handler(httpd_req_t *req)
 {
+    metrics_http(HTTP_EP_CONFIG);
     if (config_clear())
     {
         logbuf_add(LOG_LVL_WARN, "CFG", "Configuracoes apagadas");
@@ -228,50 +328,283 @@ static esp_err_t config_clear_handler(httpd_req_t *req)
     }
 }
 
+// Logs persistidos em flash (/logs?persisted=1&since=<pseq>), incluindo
+// boots anteriores; lidos em blocos e enviados em chunks
+static esp_err_t logs_persisted_handler(httpd_req_t *req, uint32_t since)
+{
+    logstore_stats_t st = logstore_get_stats();
+    if (!st.enabled)
+    {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Log persistence disabled");
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+
+    char item[192];
+    int n = snprintf(item, sizeof(item), "{\"boot\":%u,\"entries\":[", (unsigned)st.boot);
+    esp_err_t ret = httpd_resp_send_chunk(req, item, (size_t)n);
+    if (ret != ESP_OK)
+        return ret;
+
+    logstore_entry_t blk[8];
+    uint32_t cursor = since;
+    bool any = false;
+    int got;
+    while ((got = logstore_read(&cursor, blk, 8)) > 0)
+    {
+        for (int i = 0; i < got; ++i)
+        {
+            const logstore_entry_t *e = &blk[i];
+            const char *lvl = (e->level == LOG_LVL_ERROR) ? "ERROR" : (e->level == LOG_LVL_WARN) ? "WARN"
+                                                                                                 : "INFO";
+            n = snprintf(item, sizeof(item),
+                         "%s{\"pseq\":%lu,\"boot\":%u,\"ts_ms\":%lu,\"level\":\"%s\",\"tag\":\"%s\",\"msg\":\"%s\"}",
+                         any ? "," : "", (unsigned long)e->pseq, (unsigned)e->boot, (unsigned long)e->ts_ms,
+                         lvl, e->tag, e->msg);
+            ret = httpd_resp_send_chunk(req, item, (size_t)n);
+            if (ret != ESP_OK)
+                return ret;
+            any = true;
+        }
+    }
+
+    ret = httpd_resp_send_chunk(req, "]}", 2);
+    if (ret != ESP_OK)
+        return ret;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Logs incrementais: /logs?since=<seq> devolve apenas entradas com
+// sequência maior que 'since' e o cursor 'head' para a próxima consulta.
+// ETag = head; If-None-Match igual responde 304 sem corpo.
+// Envia em chunks as entradas (seq > since) até 'head', separadas por vírgula.
+// Janela atual: últimas LOGBUF_MAX sequências; entradas já sobrescritas são
+// puladas por logbuf_read.
+static esp_err_t send_log_entries(httpd_req_t *req, uint32_t since, uint32_t head)
+{
+    char item[256];
+    uint32_t first = head > LOGBUF_MAX ? head - LOGBUF_MAX + 1 : 1;
+    if (since >= first && since <= head)
+        first = since + 1;
+    bool any = false;
+
+    for (uint32_t seq = first; seq <= head && seq != 0; ++seq)
+    {
+        log_entry_t e;
+        if (!logbuf_read(seq, &e))
+            continue;
+        if (any)
+            item[0] = ',';
+        int n = logbuf_entry_json(&e, item + (any ? 1 : 0), sizeof(item) - 1);
+        if (n <= 0)
+            continue;
+        n += any ? 1 : 0;
+        esp_err_t ret = httpd_resp_send_chunk(req, item, (size_t)n);
+        if (ret != ESP_OK)
+            return ret;
+        any = true;
+    }
+    return ESP_OK;
+}
+
 static esp_err_t logs_handler(httpd_req_t *req)
 {
+    metrics_http(HTTP_EP_LOGS);
+    uint32_t since = 0;
+    char query[32] = {0};
+    char val[12] = {0};
+    bool persisted = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        if (httpd_query_key_value(query, "since", val, sizeof(val)) == ESP_OK)
+            since = (uint32_t)strtoul(val, NULL, 10);
+        if (httpd_query_key_value(query, "persisted", val, sizeof(val)) == ESP_OK)
+            persisted = strcmp(val, "1") == 0;
+    }
+    if (persisted)
+        return logs_persisted_handler(req, since);
+
+    uint32_t head = logbuf_committed_seq();
+    char etag[16];
+    snprintf(etag, sizeof(etag), "\"%lu\"", (unsigned long)head);
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    char inm[16] = {0};
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK &&
+        strcmp(inm, etag) == 0)
+    {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
     // Serializa em chunks para reduzir uso de memória e evitar fragmentação
     httpd_resp_set_type(req, "application/json");
 
-    // Início de array
-    esp_err_t ret = httpd_resp_send_chunk(req, "[", 1);
+    char item[32];
+    int n = snprintf(item, sizeof(item), "{\"head\":%lu,\"entries\":[", (unsigned long)head);
+    esp_err_t ret = httpd_resp_send_chunk(req, item, (size_t)n);
+    if (ret == ESP_OK)
+        ret = send_log_entries(req, since, head);
+    if (ret == ESP_OK)
+        ret = httpd_resp_send_chunk(req, "]}", 2);
     if (ret != ESP_OK)
         return ret;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
 
-    // Determina janela atual do buffer
-    extern uint32_t g_count;    // declarado em logbuf.cpp
-    extern uint32_t g_head;     // declarado em logbuf.cpp
-    extern log_entry_t g_buf[]; // declarado em logbuf.cpp
+// Status, alertas e logs novos em uma única resposta:
+// /api/snapshot?since=<seq> -> {"status":{...},"alerts":{...},"logs":{"head":N,"entries":[...]}}
+// Substitui o par /status + /logs do dashboard (metade das conexões).
+static esp_err_t snapshot_handler(httpd_req_t *req)
+{
+    metrics_http(HTTP_EP_SNAPSHOT);
+    uint32_t since = 0;
+    char query[32] = {0};
+    char val[12] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since", val, sizeof(val)) == ESP_OK)
+        since = (uint32_t)strtoul(val, NULL, 10);
 
-    uint32_t valid = g_count < 100 ? g_count : 100; // LOGBUF_MAX = 100
-    uint32_t start = (g_count >= 100) ? g_head : 0;
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
 
-    char item[256];
-    for (uint32_t i = 0; i < valid; ++i)
+    char json[STATUS_JSON_MAX];
+    int n = snprintf(json, sizeof(json), "{\"status\":");
+    int len = status_snapshot(json + n, sizeof(json) - (size_t)n);
+    if (len <= 0)
+        len = (int)strlcpy(json + n, "null", sizeof(json) - (size_t)n);
+    esp_err_t ret = httpd_resp_send_chunk(req, json, (size_t)(n + len));
+    if (ret != ESP_OK)
+        return ret;
+
+    uint32_t head = logbuf_committed_seq();
+    n = snprintf(json, sizeof(json), ",\"alerts\":{\"rain\":\"%s\",\"temp\":\"%s\"},\"logs\":{\"head\":%lu,\"entries\":[",
+                 alert_color_str(alert_get_rain_color()), alert_color_str(alert_get_temp_color()),
+                 (unsigned long)head);
+    ret = httpd_resp_send_chunk(req, json, (size_t)n);
+    if (ret == ESP_OK)
+        ret = send_log_entries(req, since, head);
+    if (ret == ESP_OK)
+        ret = httpd_resp_send_chunk(req, "]}}", 3);
+    if (ret != ESP_OK)
+        return ret;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Histórico: /history?res=raw|1m|1h&from=<ts_s> (segundos de uptime)
+// Lido em blocos pequenos direto dos anéis e enviado em chunks. Para 1m/1h,
+// "partial" traz o intervalo ainda em andamento (ou null).
+static void fmt_temp(char *out, size_t size, int16_t t)
+{
+    if (t == HISTORY_TEMP_NONE)
+        strlcpy(out, "null", size);
+    else
+        snprintf(out, size, "%.1f", t / 10.0);
+}
+
+static void fmt_pct(char *out, size_t size, uint8_t v)
+{
+    if (v == HISTORY_PCT_NONE)
+        strlcpy(out, "null", size);
+    else
+        snprintf(out, size, "%u", (unsigned)v);
+}
+
+// Agregado como [ts,t_min,t_max,t_avg,h_min,h_max,h_avg,r_min,r_max,r_avg]
+static int fmt_rollup(char *out, size_t size, const char *prefix, const history_rollup_t *e)
+{
+    char t0[8], t1[8], t2[8], h0[6], h1[6], h2[6];
+    fmt_temp(t0, sizeof(t0), e->t_min);
+    fmt_temp(t1, sizeof(t1), e->t_max);
+    fmt_temp(t2, sizeof(t2), e->t_avg);
+    fmt_pct(h0, sizeof(h0), e->h_min);
+    fmt_pct(h1, sizeof(h1), e->h_max);
+    fmt_pct(h2, sizeof(h2), e->h_avg);
+    return snprintf(out, size, "%s[%lu,%s,%s,%s,%s,%s,%s,%u,%u,%u]", prefix,
+                    (unsigned long)e->ts_s, t0, t1, t2, h0, h1, h2,
+                    (unsigned)e->r_min, (unsigned)e->r_max, (unsigned)e->r_avg);
+}
+
+static esp_err_t history_handler(httpd_req_t *req)
+{
+    metrics_http(HTTP_EP_HISTORY);
+    char query[64] = {0};
+    char val[16] = {0};
+    history_res_t res = HISTORY_RES_1M;
+    uint32_t from_s = 0;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        if (httpd_query_key_value(query, "res", val, sizeof(val)) == ESP_OK)
+        {
+            if (strcmp(val, "raw") == 0)
+                res = HISTORY_RES_RAW;
+            else if (strcmp(val, "1h") == 0)
+                res = HISTORY_RES_1H;
+            else if (strcmp(val, "1m") != 0)
+            {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "res must be raw, 1m or 1h");
+                return ESP_FAIL;
+            }
+        }
+        if (httpd_query_key_value(query, "from", val, sizeof(val)) == ESP_OK)
+            from_s = (uint32_t)strtoul(val, NULL, 10);
+    }
+
+    static const char *res_names[] = {"raw", "1m", "1h"};
+    httpd_resp_set_type(req, "application/json");
+    char item[160];
+    int n = snprintf(item, sizeof(item), "{\"res\":\"%s\",\"now_s\":%lu,\"points\":[",
+                     res_names[res], (unsigned long)(esp_timer_get_time() / 1000000LL));
+    esp_err_t ret = httpd_resp_send_chunk(req, item, (size_t)n);
+    if (ret != ESP_OK)
+        return ret;
+
+    union {
+        history_raw_t raw[16];
+        history_rollup_t rollup[16];
+    } blk;
+    uint32_t cursor = 0;
+    bool first = true;
+    int got;
+    while ((got = history_read(res, from_s, &cursor, &blk, 16)) > 0)
     {
-        uint32_t idx = (start + i) % 100;
-        log_entry_t *e = &g_buf[idx];
-        // vírgula separadora
-        if (i > 0)
+        for (int i = 0; i < got; ++i)
         {
-            ret = httpd_resp_send_chunk(req, ",", 1);
+            if (res == HISTORY_RES_RAW)
+            {
+                const history_raw_t *e = &blk.raw[i];
+                char t0[8], h0[6];
+                fmt_temp(t0, sizeof(t0), e->temp);
+                fmt_pct(h0, sizeof(h0), e->hum);
+                n = snprintf(item, sizeof(item), "%s[%lu,%s,%s,%u]", first ? "" : ",",
+                             (unsigned long)e->ts_s, t0, h0, (unsigned)e->rain);
+            }
+            else
+            {
+                n = fmt_rollup(item, sizeof(item), first ? "" : ",", &blk.rollup[i]);
+            }
+            first = false;
+            ret = httpd_resp_send_chunk(req, item, (size_t)n);
             if (ret != ESP_OK)
                 return ret;
         }
-        const char *lvl = (e->level == LOG_LVL_ERROR) ? "ERROR" : (e->level == LOG_LVL_WARN) ? "WARN"
-                                                                                             : "INFO";
-        int n = snprintf(item, sizeof(item),
-                         "{\"seq\":%lu,\"ts_ms\":%lu,\"level\":\"%s\",\"tag\":\"%s\",\"msg\":\"%s\"}",
-                         (unsigned long)e->seq, (unsigned long)e->ts_ms, lvl, e->tag, e->msg);
-        if (n < 0)
-            continue;
-        ret = httpd_resp_send_chunk(req, item, (size_t)n);
-        if (ret != ESP_OK)
-            return ret;
     }
 
-    // Fim do array e encerra chunked
-    ret = httpd_resp_send_chunk(req, "]", 1);
+    // Intervalo corrente, ainda não fechado (até 1 min ou 1 h de amostras)
+    history_rollup_t part;
+    n = 0;
+    if (res != HISTORY_RES_RAW && history_partial(res, &part) && part.ts_s >= from_s)
+        n = fmt_rollup(item, sizeof(item), "],\"partial\":", &part);
+    if (n > 0 && n < (int)sizeof(item) - 1)
+    {
+        item[n++] = '}';
+        ret = httpd_resp_send_chunk(req, item, (size_t)n);
+    }
+    else
+    {
+        ret = httpd_resp_send_chunk(req, res == HISTORY_RES_RAW ? "]}" : "],\"partial\":null}", HTTPD_RESP_USE_STRLEN);
+    }
     if (ret != ESP_OK)
         return ret;
     return httpd_resp_send_chunk(req, NULL, 0);
@@ -282,26 +615,13 @@ httpd_handle_t webserver_start()
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     // Habilita wildcard para servir quaisquer arquivos via "/*"
     config.uri_match_fn = httpd_uri_match_wildcard;
+    config.max_uri_handlers = 12;
     httpd_handle_t server = NULL;
 
-    // Monta SPIFFS em /spiffs
-    esp_vfs_spiffs_conf_t conf = {
-        .base_path = "/spiffs",
-        .partition_label = "storage",
-        .max_files = 8,
-        .format_if_mount_failed = true,
-    };
-    esp_err_t sret = esp_vfs_spiffs_register(&conf);
-    if (sret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Falha ao montar SPIFFS (%d)", (int)sret);
-        logbuf_add(LOG_LVL_ERROR, TAG, "Falha ao montar SPIFFS");
-    }
-    else
-    {
-        ESP_LOGI(TAG, "SPIFFS montado em /spiffs");
-        logbuf_add(LOG_LVL_INFO, TAG, "SPIFFS montado");
-    }
+    s_status_lock = xSemaphoreCreateMutex();
+
+    // Assets servidos da imagem mapeada da partição 'storage' (sem SPIFFS)
+    web_assets_init();
 
     if (httpd_start(&server, &config) == ESP_OK)
     {
@@ -310,12 +630,21 @@ httpd_handle_t webserver_start()
         httpd_uri_t cfg_get = {.uri = "/api/config", .method = HTTP_GET, .handler = config_get_handler, .user_ctx = NULL};
         httpd_uri_t cfg_post = {.uri = "/api/config", .method = HTTP_POST, .handler = config_post_handler, .user_ctx = NULL};
         httpd_uri_t cfg_clear = {.uri = "/api/config/clear", .method = HTTP_POST, .handler = config_clear_handler, .user_ctx = NULL};
+        httpd_uri_t history = {.uri = "/history", .method = HTTP_GET, .handler = history_handler, .user_ctx = NULL};
+        httpd_uri_t events = {.uri = "/events", .method = HTTP_GET, .handler = sse_events_handler, .user_ctx = NULL};
+        httpd_uri_t snapshot = {.uri = "/api/snapshot", .method = HTTP_GET, .handler = snapshot_handler, .user_ctx = NULL};
+        httpd_uri_t metrics = {.uri = "/metrics", .method = HTTP_GET, .handler = metrics_handler, .user_ctx = NULL};
         // Registra endpoints primeiro para evitar captura pelo wildcard
         httpd_register_uri_handler(server, &status);
         httpd_register_uri_handler(server, &logs);
         httpd_register_uri_handler(server, &cfg_get);
         httpd_register_uri_handler(server, &cfg_post);
         httpd_register_uri_handler(server, &cfg_clear);
+        httpd_register_uri_handler(server, &history);
+        httpd_register_uri_handler(server, &events);
+        httpd_register_uri_handler(server, &snapshot);
+        httpd_register_uri_handler(server, &metrics);
+        sse_init(server);
         // Wildcard para arquivos estáticos
         httpd_uri_t files = {.uri = "/*", .method = HTTP_GET, .handler = file_handler, .user_ctx = NULL};
         httpd_register_uri_handler(server, &files);
@@ -5,5 +5,8 @@
 
 httpd_handle_t webserver_start();
 
+// Envia o status atual aos clientes de /events (se houver)
+void webserver_push_status(void);
+
 #endif // WEBSERVER_H
 
@@ -1,6 +1,7 @@
 #include "wifi.h"
 #include "esp_log.h"
 #include "logbuf.h"
+#include "metrics.h"
 #include <string.h>
 
 static const char *TAG = "WIFI";
@@ -20,6 +21,7 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
     {
         ESP_LOGW(TAG, "Wi-Fi desconectado, tentando reconectar...");
         logbuf_add(LOG_LVL_WARN, TAG, "Wi-Fi desconectado, reconectando");
+        metrics_inc(MET_WIFI_DISCONNECT);
         esp_wifi_connect();
         xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     }
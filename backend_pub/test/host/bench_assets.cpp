@@ -0,0 +1,104 @@
+#include "web_assets.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+// Microbenchmark (fora do ctest): custo de CPU do handler de arquivos por
+// requisição, antes (fopen + fread em blocos de 1 KB + envio em chunks do
+// arquivo cru) e depois (busca binária na tabela gzip + um único envio).
+// O envio é uma cópia para um buffer no lugar do socket; rede e SPIFFS
+// não entram, então no dispositivo a diferença tende a ser maior.
+
+static char s_sock[32 * 1024];
+static size_t s_sock_len = 0;
+static uint32_t s_sum = 0;
+
+static void sock_send(const char *p, size_t n)
+{
+    if (s_sock_len + n > sizeof(s_sock))
+        s_sock_len = 0;
+    memcpy(s_sock + s_sock_len, p, n);
+    s_sock_len += n;
+    s_sum += (uint8_t)p[n ? n - 1 : 0];
+}
+
+// Handler original (SPIFFS), com a raiz em WEB_DIR
+static size_t handler_before(const char *uri)
+{
+    std::string path = WEB_DIR;
+    if (strcmp(uri, "/") == 0)
+        path += "/index.html";
+    else
+        path += uri;
+
+    FILE *fd = fopen(path.c_str(), "r");
+    if (!fd)
+        return 0;
+    const char *mime = path.find(".css") != std::string::npos  ? "text/css"
+                       : path.find(".js") != std::string::npos ? "application/javascript"
+                                                               : "text/html";
+    sock_send(mime, strlen(mime));
+
+    char chunk[1024];
+    size_t chunksize;
+    size_t total = 0;
+    while ((chunksize = fread(chunk, 1, sizeof(chunk), fd)) > 0)
+    {
+        sock_send(chunk, chunksize);
+        total += chunksize;
+    }
+    fclose(fd);
+    return total;
+}
+
+// Handler atual (tabela embutida; a imagem mapeada usa a mesma busca)
+static size_t handler_after(const char *uri, const char *if_none_match)
+{
+    size_t uri_len = strcspn(uri, "?");
+    web_asset_t a;
+    bool found = (uri_len == 1 && uri[0] == '/') ? web_assets_find("/index.html", 11, &a)
+                                                 : web_assets_find(uri, uri_len, &a);
+    if (!found)
+        return 0;
+    sock_send(a.etag, strlen(a.etag));
+    if (if_none_match && strstr(if_none_match, a.etag))
+        return 0; // 304
+    sock_send(a.mime, strlen(a.mime));
+    sock_send((const char *)a.gz, a.gz_len);
+    return a.gz_len;
+}
+
+template <typename F>
+static double run(int iters, F handler, size_t *bytes)
+{
+    *bytes = handler();
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < iters; ++i)
+        handler();
+    return (esp_timer_get_time() - t0) * 1000.0 / iters;
+}
+
+int main()
+{
+    const int iters = 200000;
+    web_assets_init();
+
+    printf("%-12s %10s %10s %12s %12s\n", "arquivo", "B antes", "B depois", "ns antes", "ns depois");
+    for (const char *uri : {"/", "/script.js", "/style.css"})
+    {
+        size_t b0, b1;
+        double t0 = run(iters, [&] { return handler_before(uri); }, &b0);
+        double t1 = run(iters, [&] { return handler_after(uri, nullptr); }, &b1);
+        printf("%-12s %10zu %10zu %12.0f %12.0f\n", uri, b0, b1, t0, t1);
+    }
+
+    // Revalidação do index.html com o ETag atual: 304 sem corpo
+    web_asset_t idx;
+    web_assets_find("/index.html", 11, &idx);
+    size_t b304;
+    double t304 = run(iters, [&] { return handler_after("/", idx.etag); }, &b304);
+    printf("%-12s %10s %10zu %12s %12.0f\n", "/ (304)", "-", b304, "-", t304);
+
+    return s_sum == 0xFFFFFFFFu; // mantém as cópias vivas
+}
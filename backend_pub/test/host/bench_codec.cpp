@@ -0,0 +1,176 @@
+#include "payload.h"
+#include "telemetry-codec.h" // decodificador do assinante (frontend_sub)
+#include "esp_timer.h"
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef BENCH_CJSON
+#include "cJSON.h"
+#endif
+
+// Microbenchmark (fora do ctest): mensagens/s do parser do assinante e
+// chamadas de heap por mensagem, contra o caminho antigo (cópia com malloc
+// + cJSON_Parse) quando o cJSON do ESP-IDF está disponível (BENCH_CJSON).
+// malloc/calloc/realloc/free são interceptados com --wrap no link;
+// operator new/delete são substituídos.
+
+static std::atomic<uint64_t> s_heap_calls{0};
+
+extern "C" {
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t sz);
+void *__real_realloc(void *p, size_t n);
+void __real_free(void *p);
+
+void *__wrap_malloc(size_t n)
+{
+    s_heap_calls++;
+    return __real_malloc(n);
+}
+void *__wrap_calloc(size_t n, size_t sz)
+{
+    s_heap_calls++;
+    return __real_calloc(n, sz);
+}
+void *__wrap_realloc(void *p, size_t n)
+{
+    s_heap_calls++;
+    return __real_realloc(p, n);
+}
+void __wrap_free(void *p)
+{
+    if (p)
+        s_heap_calls++;
+    __real_free(p);
+}
+}
+
+void *operator new(size_t n)
+{
+    s_heap_calls++;
+    if (void *p = __real_malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept
+{
+    if (p)
+        s_heap_calls++;
+    __real_free(p);
+}
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+static sample_t make_sample(int i)
+{
+    sample_t s = {};
+    s.ts_us = (int64_t)i * 1000000;
+    s.temp = 20.0f + i * 0.25f;
+    s.hum = 55.0f;
+    s.rain_pct = i * 5;
+    s.dht_ok = true;
+    s.seq = (uint32_t)i + 1;
+    s.boot = 3;
+    s.epoch_ms = 1760000000000ULL + (uint64_t)i * 1000;
+    return s;
+}
+
+#ifdef BENCH_CJSON
+// Caminho original do assinante: copia o payload para terminar em '\0',
+// cJSON_Parse e leitura dos campos da amostra (ou de cada item de "samples")
+static int cjson_sample(const cJSON *o)
+{
+    int n = 0;
+    n += cJSON_IsNumber(cJSON_GetObjectItem(o, "dht_temp"));
+    n += cJSON_IsNumber(cJSON_GetObjectItem(o, "dht_hum"));
+    n += cJSON_IsNumber(cJSON_GetObjectItem(o, "rain_pct"));
+    return n;
+}
+
+static int cjson_parse(const char *data, size_t len)
+{
+    char *buffer = (char *)malloc(len + 1);
+    if (!buffer)
+        return 0;
+    memcpy(buffer, data, len);
+    buffer[len] = '\0';
+    int count = 0;
+    cJSON *root = cJSON_Parse(buffer);
+    if (root)
+    {
+        const cJSON *samples = cJSON_GetObjectItem(root, "samples");
+        if (cJSON_IsArray(samples))
+        {
+            const cJSON *it;
+            cJSON_ArrayForEach(it, samples)
+            {
+                if (cjson_sample(it) == 3)
+                    count++;
+            }
+        }
+        else if (cjson_sample(root) == 3)
+            count = 1;
+        cJSON_Delete(root);
+    }
+    free(buffer);
+    return count;
+}
+#endif
+
+template <typename F>
+static void run(const char *name, int iters, F parse)
+{
+    uint64_t heap0 = s_heap_calls.load();
+    int64_t t0 = esp_timer_get_time();
+    int ok = 0;
+    for (int i = 0; i < iters; ++i)
+        ok += parse();
+    int64_t us = esp_timer_get_time() - t0;
+    uint64_t heap = s_heap_calls.load() - heap0;
+    printf("%-26s %10.0f msg/s %8.2f heap/msg%s\n", name, iters * 1e6 / (double)us, (double)heap / iters,
+           ok == iters ? "" : "  (FALHA)");
+}
+
+int main()
+{
+    static char one[256];
+    static char batch[2048];
+    static uint8_t bin[PAYLOAD_BIN_HEADER_LEN + PAYLOAD_BATCH_MAX * PAYLOAD_BIN_SAMPLE_LEN];
+
+    sample_t s[PAYLOAD_BATCH_MAX];
+    for (int i = 0; i < PAYLOAD_BATCH_MAX; ++i)
+        s[i] = make_sample(i);
+    int one_len = payload_encode_json(&s[0], one, sizeof(one));
+    int batch_len = payload_encode_json_batch(s, PAYLOAD_BATCH_MAX, false, batch, sizeof(batch));
+    int bin_len = payload_encode_bin(s, PAYLOAD_BATCH_MAX, false, bin, sizeof(bin));
+    printf("JSON simples %d B, lote JSON %d B, lote binario %d B (%d amostras)\n", one_len, batch_len, bin_len,
+           PAYLOAD_BATCH_MAX);
+
+    static TelemetryBatch b;
+    run("JSON, 1 amostra", 2000000, [&] {
+        return TelemetryCodec::parseJson(one, (size_t)one_len, b) && b.count == 1;
+    });
+    run("JSON, lote de 16", 200000, [&] {
+        return TelemetryCodec::parseJson(batch, (size_t)batch_len, b) && b.count == PAYLOAD_BATCH_MAX;
+    });
+#ifdef BENCH_CJSON
+    run("cJSON, 1 amostra", 500000, [&] { return cjson_parse(one, (size_t)one_len) == 1; });
+    run("cJSON, lote de 16", 50000, [&] { return cjson_parse(batch, (size_t)batch_len) == PAYLOAD_BATCH_MAX; });
+#else
+    printf("cJSON: indisponivel (defina IDF_PATH ou CJSON_DIR ao configurar)\n");
+#endif
+    run("binario, lote de 16", 2000000, [&] {
+        int n = TelemetryCodec::binarySampleCount((const char *)bin, (size_t)bin_len);
+        TelemetrySample t;
+        bool ok = n == PAYLOAD_BATCH_MAX;
+        for (int i = 0; ok && i < n; ++i)
+            ok = TelemetryCodec::decodeSample((const char *)bin, (size_t)bin_len, i, t);
+        return ok;
+    });
+    return 0;
+}
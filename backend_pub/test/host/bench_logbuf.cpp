@@ -0,0 +1,62 @@
+#include "logbuf.h"
+#include "esp_timer.h"
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+// Microbenchmark (fora do ctest): logbuf_add sem trava contra o mesmo
+// registro de 16 bytes protegido por mutex, com 1 e 4 produtores.
+
+struct locked_slot_t
+{
+    uint32_t seq, ts_ms;
+    const char *msg;
+    uint8_t tag, level;
+    int16_t arg;
+};
+
+static locked_slot_t s_locked[LOGBUF_MAX];
+static uint32_t s_locked_seq = 0;
+static std::mutex s_mutex;
+
+static void locked_add(const char *msg)
+{
+    std::lock_guard<std::mutex> g(s_mutex);
+    uint32_t seq = ++s_locked_seq;
+    locked_slot_t &s = s_locked[(seq - 1) % LOGBUF_MAX];
+    s.seq = seq;
+    s.ts_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    s.msg = msg;
+    s.tag = 0;
+    s.level = 0;
+    s.arg = 0;
+}
+
+template <typename F>
+static double run(int threads, int per_thread, F add)
+{
+    int64_t t0 = esp_timer_get_time();
+    std::vector<std::thread> ws;
+    for (int i = 0; i < threads; ++i)
+        ws.emplace_back([&] {
+            for (int k = 0; k < per_thread; ++k)
+                add();
+        });
+    for (auto &t : ws)
+        t.join();
+    return (esp_timer_get_time() - t0) * 1000.0 / ((double)threads * per_thread);
+}
+
+int main()
+{
+    const int per_thread = 2000000;
+    for (int threads : {1, 4})
+    {
+        logbuf_init();
+        double lf = run(threads, per_thread, [] { logbuf_add(LOG_LVL_INFO, "BENCH", "mensagem"); });
+        double mx = run(threads, per_thread, [] { locked_add("mensagem"); });
+        printf("%d produtor(es): sem trava %.1f ns/op | mutex %.1f ns/op\n", threads, lf, mx);
+    }
+    return 0;
+}
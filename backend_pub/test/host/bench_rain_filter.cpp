@@ -0,0 +1,115 @@
+#include "rain_filter.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Benchmark (fora do ctest): filtro do FC-37 sobre um traço de leituras
+// brutas, contra a leitura única por período do firmware original.
+//   ./bench_rain_filter [traço]   (padrão: traces/fc37_synthetic.txt)
+// Formato: um valor ADC por linha, '#' comenta; RAIN_BURST_LEN por período.
+// Reporta o custo por aquisição, a variação entre períodos consecutivos e
+// quantas vezes a % cruza o limiar de chuva média (10%).
+
+#define RAIN_MID_PCT 10
+
+struct trace_t
+{
+    std::vector<uint16_t> data;
+    size_t pos;
+};
+
+static int trace_read(void *ctx, uint16_t *buf, int n)
+{
+    trace_t *t = (trace_t *)ctx;
+    int got = 0;
+    while (got < n && t->pos < t->data.size())
+        buf[got++] = t->data[t->pos++];
+    return got;
+}
+
+static bool load(const char *path, std::vector<uint16_t> &out)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+    char line[64];
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+        out.push_back((uint16_t)atoi(line));
+    }
+    fclose(f);
+    return true;
+}
+
+struct stats_t
+{
+    double mean_step; // |pct[i] - pct[i-1]| médio
+    int max_step;
+    int crossings;    // transições através de RAIN_MID_PCT
+};
+
+static stats_t analyze(const std::vector<int> &pct)
+{
+    stats_t st = {};
+    long sum = 0;
+    for (size_t i = 1; i < pct.size(); ++i)
+    {
+        int step = abs(pct[i] - pct[i - 1]);
+        sum += step;
+        if (step > st.max_step)
+            st.max_step = step;
+        if ((pct[i] >= RAIN_MID_PCT) != (pct[i - 1] >= RAIN_MID_PCT))
+            st.crossings++;
+    }
+    st.mean_step = pct.size() > 1 ? (double)sum / (double)(pct.size() - 1) : 0.0;
+    return st;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : TRACE_DEFAULT;
+    trace_t t = {{}, 0};
+    if (!load(path, t.data) || t.data.size() < RAIN_BURST_LEN)
+    {
+        fprintf(stderr, "traço inválido: %s\n", path);
+        return 1;
+    }
+    size_t periods = t.data.size() / RAIN_BURST_LEN;
+
+    // Firmware original: uma leitura do ADC por período
+    std::vector<int> single;
+    for (size_t p = 0; p < periods; ++p)
+        single.push_back(rain_raw_to_pct(t.data[p * RAIN_BURST_LEN]));
+
+    // Filtro: mediana da rajada + média móvel
+    std::vector<int> filtered;
+    rain_filter_t f;
+    rain_filter_init(&f, rain_source_t{trace_read, &t});
+    int pct;
+    while ((size_t)filtered.size() < periods && (pct = rain_filter_acquire(&f, nullptr)) >= 0)
+        filtered.push_back(pct);
+
+    // Custo por aquisição, repetindo o traço
+    const int iters = 200000;
+    int64_t t0 = esp_timer_get_time();
+    long sink = 0;
+    for (int i = 0; i < iters; ++i)
+    {
+        if (t.pos + RAIN_BURST_LEN > t.data.size())
+            t.pos = 0;
+        sink += rain_filter_acquire(&f, nullptr);
+    }
+    double ns = (esp_timer_get_time() - t0) * 1000.0 / iters;
+
+    stats_t a = analyze(single);
+    stats_t b = analyze(filtered);
+    printf("traço: %s (%zu períodos de %d leituras)\n", path, periods, RAIN_BURST_LEN);
+    printf("%-16s %12s %10s %18s\n", "", "passo médio", "passo máx", "cruzamentos 10%");
+    printf("%-16s %11.2f%% %9d%% %18d\n", "leitura única", a.mean_step, a.max_step, a.crossings);
+    printf("%-16s %11.2f%% %9d%% %18d\n", "mediana+média", b.mean_step, b.max_step, b.crossings);
+    printf("rain_filter_acquire: %.0f ns/aquisição\n", ns);
+    return sink == -1;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdio.h>
+
+// Verificação mínima para os testes de host: conta falhas e segue adiante
+static int g_failures = 0;
+
+#define CHECK(cond)                                                          \
+    do                                                                       \
+    {                                                                        \
+        if (!(cond))                                                         \
+        {                                                                    \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                    \
+        }                                                                    \
+    } while (0)
+
+static inline int test_result(const char *name)
+{
+    if (g_failures)
+        fprintf(stderr, "%s: %d falha(s)\n", name, g_failures);
+    else
+        printf("%s: ok\n", name);
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+
+// Relógio monotônico do host no lugar do esp_timer
+static inline int64_t esp_timer_get_time(void)
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+
+// Substituto mínimo para compilar no host os headers que só usam os tipos
+typedef uint32_t TickType_t;
@@ -0,0 +1,146 @@
+#include "host_test.h"
+#include "alert_rules.h"
+#include <math.h>
+#include <string.h>
+
+// Motor compartilhado (components/alert_rules), tabela padrão:
+// temperatura 25/30 °C (histerese 0,5), chuva 10/50 % (histerese 3), 10 s
+
+static uint32_t feed(alert_engine_t *e, float temp, float rain, int64_t now_ms)
+{
+    float in[ALERT_IN_COUNT] = {temp, NAN, rain};
+    return alert_engine_update(e, in, now_ms);
+}
+
+static void init_default(alert_engine_t *e)
+{
+    alert_thresholds_t th;
+    alert_thresholds_default(&th);
+    alert_engine_init(e, &th);
+}
+
+// Primeira leitura define o nível direto, sem permanência
+static void test_primed_first_sample()
+{
+    alert_engine_t e;
+    init_default(&e);
+    CHECK(feed(&e, 31.0f, 60.0f, 0) == ((1u << ALERT_RULE_TEMP) | (1u << ALERT_RULE_RAIN)));
+    CHECK(alert_engine_level(&e, ALERT_RULE_TEMP) == 2);
+    CHECK(alert_engine_level(&e, ALERT_RULE_RAIN) == 2);
+
+    // Primeira leitura normal: nada muda (nível 0 já era o inicial)
+    init_default(&e);
+    CHECK(feed(&e, 20.0f, 0.0f, 0) == 0);
+    CHECK(e.state[ALERT_RULE_TEMP].primed);
+}
+
+// Entrada em >= limiar após o dwell; saída só abaixo de limiar - histerese
+static void test_enter_exit_bands()
+{
+    alert_engine_t e;
+    init_default(&e);
+    feed(&e, 20.0f, NAN, 0);
+
+    CHECK(feed(&e, 25.0f, NAN, 1000) == 0); // candidato "media"
+    CHECK(feed(&e, 25.2f, NAN, 1000 + ALERT_DWELL_MS - 1) == 0);
+    CHECK(feed(&e, 25.1f, NAN, 1000 + ALERT_DWELL_MS) == (1u << ALERT_RULE_TEMP));
+    CHECK(alert_engine_level(&e, ALERT_RULE_TEMP) == 1);
+    CHECK(strcmp(alert_engine_label(&e, ALERT_RULE_TEMP), "media") == 0);
+
+    // Dentro da banda (24,5..25): continua "media", sem candidato
+    int64_t t = 20000;
+    CHECK(feed(&e, 24.6f, NAN, t) == 0);
+    CHECK(feed(&e, 24.6f, NAN, t + 2 * ALERT_DWELL_MS) == 0);
+    CHECK(alert_engine_level(&e, ALERT_RULE_TEMP) == 1);
+
+    // Abaixo da banda: desce após o dwell
+    t = 50000;
+    CHECK(feed(&e, 24.4f, NAN, t) == 0);
+    CHECK(feed(&e, 24.4f, NAN, t + ALERT_DWELL_MS) == (1u << ALERT_RULE_TEMP));
+    CHECK(alert_engine_level(&e, ALERT_RULE_TEMP) == 0);
+
+    // Chuva: salto direto de sem_chuva para chuva_forte
+    t = 100000;
+    feed(&e, NAN, 0.0f, t);
+    CHECK(feed(&e, NAN, 55.0f, t + 1) == 0);
+    CHECK(feed(&e, NAN, 55.0f, t + 1 + ALERT_DWELL_MS) == (1u << ALERT_RULE_RAIN));
+    CHECK(strcmp(alert_engine_label(&e, ALERT_RULE_RAIN), "chuva_forte") == 0);
+    // 48 % ainda está na banda de chuva_forte (50 - 3)
+    CHECK(feed(&e, NAN, 48.0f, t + 30000) == 0);
+    CHECK(feed(&e, NAN, 48.0f, t + 30000 + ALERT_DWELL_MS) == 0);
+    CHECK(alert_engine_level(&e, ALERT_RULE_RAIN) == 2);
+}
+
+// Valor que volta antes do dwell descarta o candidato; a contagem recomeça
+static void test_pending_reset()
+{
+    alert_engine_t e;
+    init_default(&e);
+    feed(&e, 20.0f, NAN, 0);
+
+    CHECK(feed(&e, 26.0f, NAN, 1000) == 0);
+    CHECK(feed(&e, 20.0f, NAN, 6000) == 0); // voltou: candidato descartado
+    CHECK(e.state[ALERT_RULE_TEMP].pending == 0);
+    CHECK(feed(&e, 26.0f, NAN, 9000) == 0); // novo candidato a partir daqui
+    CHECK(feed(&e, 26.0f, NAN, 1000 + ALERT_DWELL_MS) == 0);
+    CHECK(feed(&e, 26.0f, NAN, 9000 + ALERT_DWELL_MS) == (1u << ALERT_RULE_TEMP));
+    CHECK(e.state[ALERT_RULE_TEMP].transitions == 1);
+}
+
+// NaN não altera a regra nem reinicia a permanência
+static void test_nan_skipped()
+{
+    alert_engine_t e;
+    init_default(&e);
+    CHECK(feed(&e, NAN, NAN, 0) == 0);
+    CHECK(!e.state[ALERT_RULE_TEMP].primed && !e.state[ALERT_RULE_RAIN].primed);
+
+    feed(&e, 20.0f, 0.0f, 1000);
+    CHECK(feed(&e, 31.0f, NAN, 2000) == 0);
+    CHECK(feed(&e, NAN, 20.0f, 5000) == 0); // temperatura ausente
+    CHECK(e.state[ALERT_RULE_TEMP].pending == 2);
+    CHECK(feed(&e, 31.0f, NAN, 2000 + ALERT_DWELL_MS) == (1u << ALERT_RULE_TEMP));
+    CHECK(alert_engine_level(&e, ALERT_RULE_TEMP) == 2);
+}
+
+static void test_thresholds_sanitize()
+{
+    alert_thresholds_t th = {26.0f, 32.0f, 15.0f, 60.0f};
+    CHECK(alert_thresholds_sanitize(&th));
+    CHECK(th.temp_mid == 26.0f && th.rain_heavy == 60.0f);
+
+    // Fora de ordem: só o par inválido volta ao padrão
+    th = {30.0f, 28.0f, 15.0f, 60.0f};
+    CHECK(!alert_thresholds_sanitize(&th));
+    CHECK(th.temp_mid == ALERT_DEFAULT_TEMP_MID && th.temp_high == ALERT_DEFAULT_TEMP_HIGH);
+    CHECK(th.rain_mid == 15.0f && th.rain_heavy == 60.0f);
+
+    // Zeros (portal sem padrões) e NaN
+    th = {0.0f, 0.0f, 0.0f, 0.0f};
+    CHECK(!alert_thresholds_sanitize(&th));
+    CHECK(th.temp_high == ALERT_DEFAULT_TEMP_HIGH && th.rain_mid == ALERT_DEFAULT_RAIN_MID);
+    th = {NAN, 30.0f, 10.0f, INFINITY};
+    CHECK(!alert_thresholds_sanitize(&th));
+    CHECK(th.temp_mid == ALERT_DEFAULT_TEMP_MID && th.rain_heavy == ALERT_DEFAULT_RAIN_HEAVY);
+
+    // Chuva média precisa ser > 0
+    th = {25.0f, 30.0f, 0.0f, 40.0f};
+    CHECK(!alert_thresholds_sanitize(&th));
+    CHECK(th.rain_mid == ALERT_DEFAULT_RAIN_MID && th.rain_heavy == ALERT_DEFAULT_RAIN_HEAVY);
+
+    // O motor sanitiza uma cópia: limiares inválidos usam os padrões
+    alert_engine_t e;
+    alert_thresholds_t bad = {0.0f, 0.0f, 0.0f, 0.0f};
+    alert_engine_init(&e, &bad);
+    CHECK(e.rules[ALERT_RULE_TEMP].enter[2] == ALERT_DEFAULT_TEMP_HIGH);
+}
+
+int main()
+{
+    test_primed_first_sample();
+    test_enter_exit_bands();
+    test_pending_reset();
+    test_nan_skipped();
+    test_thresholds_sanitize();
+    return test_result("alert_rules");
+}
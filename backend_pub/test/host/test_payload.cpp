@@ -0,0 +1,152 @@
+#include "host_test.h"
+#include "payload.h"
+#include "telemetry-codec.h" // decodificador do assinante (frontend_sub)
+#include <math.h>
+#include <string.h>
+
+static sample_t make_sample(int64_t ts_ms, float temp, float hum, int rain, uint32_t seq)
+{
+    sample_t s = {};
+    s.ts_us = ts_ms * 1000;
+    s.temp = temp;
+    s.hum = hum;
+    s.rain_pct = rain;
+    s.dht_ok = !isnan(temp);
+    s.seq = seq;
+    s.boot = 7;
+    s.epoch_ms = seq ? 1760000000000ULL + (uint64_t)ts_ms : 0;
+    return s;
+}
+
+static bool near(float a, float b)
+{
+    return fabsf(a - b) < 0.006f;
+}
+
+// Binário -> decodificador do assinante, incluindo limites do ponto fixo
+static void test_bin_roundtrip()
+{
+    const sample_t in[] = {
+        make_sample(1000, -12.34f, 0.0f, 0, 1),
+        make_sample(2000, 25.5f, 100.0f, 100, 2),
+        make_sample(3000, NAN, NAN, 37, 3),
+        make_sample(4000, 400.0f, 120.0f, 150, 0xFFFFFFFFu),  // satura
+        make_sample(5000, -400.0f, -3.0f, -5, 0),             // satura, sem SNTP
+    };
+    const int n = sizeof(in) / sizeof(in[0]);
+    uint8_t buf[PAYLOAD_BIN_HEADER_LEN + 8 * PAYLOAD_BIN_SAMPLE_LEN];
+    int len = payload_encode_bin(in, n, false, buf, sizeof(buf));
+    CHECK(len == PAYLOAD_BIN_HEADER_LEN + n * PAYLOAD_BIN_SAMPLE_LEN);
+    CHECK(buf[0] == TelemetryCodec::kMagic && buf[1] == TelemetryCodec::kVersion);
+    CHECK(TelemetryCodec::binarySampleCount((const char *)buf, (size_t)len) == n);
+    CHECK(!TelemetryCodec::isReplay((const char *)buf, (size_t)len));
+
+    TelemetrySample out[n];
+    for (int i = 0; i < n; ++i)
+        CHECK(TelemetryCodec::decodeSample((const char *)buf, (size_t)len, i, out[i]));
+
+    CHECK(out[0].ts_ms == 1000 && near(out[0].temp, -12.34f) && out[0].tempValid);
+    CHECK(near(out[0].hum, 0.0f) && out[0].humValid && out[0].rain == 0.0f);
+    CHECK(out[0].seq == 1 && out[0].boot == 7 && out[0].epochMs == 1760000001000ULL);
+    CHECK(near(out[1].temp, 25.5f) && near(out[1].hum, 100.0f) && out[1].rain == 100.0f);
+    CHECK(!out[2].tempValid && !out[2].humValid && out[2].rain == 37.0f);
+    CHECK(near(out[3].temp, 327.67f) && near(out[3].hum, 100.0f) && out[3].rain == 100.0f);
+    CHECK(out[3].seq == 0xFFFFFFFFu);
+    // -327.68 é o sentinela de inválido: o mínimo válido é -327.67
+    CHECK(out[4].tempValid && near(out[4].temp, -327.67f));
+    CHECK(near(out[4].hum, 0.0f) && out[4].rain == 0.0f && out[4].epochMs == 0);
+
+    // Ponto fixo: arredondamento para o centésimo mais próximo
+    CHECK(payload_temp_to_fixed(21.005f) == 2101 || payload_temp_to_fixed(21.005f) == 2100);
+    CHECK(payload_temp_to_fixed(-0.004f) == 0);
+    CHECK(isnan(payload_temp_from_fixed(INT16_MIN)) && isnan(payload_hum_from_fixed(0xFFFF)));
+}
+
+static void test_bin_checks()
+{
+    sample_t s[2] = {make_sample(10, 20.0f, 50.0f, 5, 1), make_sample(20, 21.0f, 51.0f, 6, 2)};
+    uint8_t buf[64];
+
+    // Buffer de saída pequeno: recusa em vez de truncar
+    CHECK(payload_encode_bin(s, 2, false, buf, PAYLOAD_BIN_HEADER_LEN + PAYLOAD_BIN_SAMPLE_LEN) == -1);
+    CHECK(payload_encode_bin(s, -1, false, buf, sizeof(buf)) == -1);
+    CHECK(payload_encode_bin(s, 0, false, buf, sizeof(buf)) == PAYLOAD_BIN_HEADER_LEN);
+
+    int len = payload_encode_bin(s, 2, true, buf, sizeof(buf));
+    CHECK(len == PAYLOAD_BIN_HEADER_LEN + 2 * PAYLOAD_BIN_SAMPLE_LEN);
+    CHECK(TelemetryCodec::isReplay((const char *)buf, (size_t)len));
+
+    // Mensagem truncada: nenhuma amostra é lida além do fim
+    TelemetrySample out;
+    CHECK(TelemetryCodec::binarySampleCount((const char *)buf, (size_t)len - 1) == -1);
+    CHECK(!TelemetryCodec::decodeSample((const char *)buf, (size_t)len - 1, 0, out));
+    CHECK(TelemetryCodec::binarySampleCount((const char *)buf, 3) == -1);
+    CHECK(!TelemetryCodec::decodeSample((const char *)buf, (size_t)len, 2, out));
+
+    // Magic/versão desconhecidos
+    uint8_t bad[64];
+    memcpy(bad, buf, (size_t)len);
+    bad[0] = '{';
+    CHECK(TelemetryCodec::binarySampleCount((const char *)bad, (size_t)len) == -1);
+    memcpy(bad, buf, (size_t)len);
+    bad[1] = 3;
+    CHECK(TelemetryCodec::binarySampleCount((const char *)bad, (size_t)len) == -1);
+
+    // v1 (10 B/amostra) continua aceita: sem seq/boot/epoch
+    uint8_t v1[TelemetryCodec::kHeaderLen + TelemetryCodec::kSampleLenV1] = {
+        TelemetryCodec::kMagic, TelemetryCodec::kVersionV1, 1, 0,
+        0x10, 0x27, 0, 0, 0x18, 0xFC, 0x88, 0x13, 42, 1};
+    CHECK(TelemetryCodec::binarySampleCount((const char *)v1, sizeof(v1)) == 1);
+    CHECK(TelemetryCodec::decodeSample((const char *)v1, sizeof(v1), 0, out));
+    CHECK(out.ts_ms == 10000 && near(out.temp, -10.0f) && near(out.hum, 50.0f) && out.rain == 42.0f);
+    CHECK(out.seq == 0 && out.epochMs == 0);
+}
+
+// JSON (simples e lote) -> parser em fluxo do assinante
+static void test_json_roundtrip()
+{
+    char buf[2048];
+    sample_t one = make_sample(1234, -5.25f, 60.0f, 0, 9);
+    int len = payload_encode_json(&one, buf, sizeof(buf));
+    CHECK(len > 0 && (size_t)len == strlen(buf));
+    TelemetryBatch b;
+    CHECK(TelemetryCodec::parseJson(buf, (size_t)len, b));
+    CHECK(b.count == 1 && !b.replay);
+    CHECK(b.samples[0].ts_ms == 1234 && near(b.samples[0].temp, -5.25f) && b.samples[0].rain == 0.0f);
+    CHECK(b.samples[0].seq == 9 && b.samples[0].boot == 7 && b.samples[0].epochMs == 1760000001234ULL);
+    CHECK(payload_encode_json(&one, buf, 20) == -1);
+
+    sample_t batch[PAYLOAD_BATCH_MAX];
+    for (int i = 0; i < PAYLOAD_BATCH_MAX; ++i)
+        batch[i] = make_sample(1000 * i, i == 3 ? NAN : 20.0f + i, 50.0f, i * 6, (uint32_t)i + 1);
+    len = payload_encode_json_batch(batch, PAYLOAD_BATCH_MAX, true, buf, sizeof(buf));
+    CHECK(len > 0);
+    CHECK(TelemetryCodec::parseJson(buf, (size_t)len, b));
+    CHECK(b.count == PAYLOAD_BATCH_MAX && b.replay);
+    CHECK(!b.samples[3].tempValid && b.samples[3].humValid);
+    CHECK(near(b.samples[15].temp, 35.0f) && b.samples[15].rain == 90.0f && b.samples[15].seq == 16);
+    CHECK(payload_encode_json_batch(batch, PAYLOAD_BATCH_MAX, false, buf, 200) == -1);
+
+    uint8_t bin[PAYLOAD_BIN_HEADER_LEN + PAYLOAD_BATCH_MAX * PAYLOAD_BIN_SAMPLE_LEN];
+    int blen = payload_encode_bin(batch, PAYLOAD_BATCH_MAX, true, bin, sizeof(bin));
+    printf("lote de %d amostras: JSON %d B, binario %d B\n", PAYLOAD_BATCH_MAX, len, blen);
+}
+
+// Chaves que são prefixo ou extensão das conhecidas não podem casar
+static void test_json_keys()
+{
+    const char msg[] = "{\"dht\":1,\"dht_temp_x\":2,\"rain\":3,\"dht_temp\":4.5,\"rain_pct\":6}";
+    TelemetryBatch b;
+    CHECK(TelemetryCodec::parseJson(msg, sizeof(msg) - 1, b));
+    CHECK(b.count == 1 && near(b.samples[0].temp, 4.5f) && b.samples[0].rain == 6.0f);
+    CHECK(!b.samples[0].humValid);
+}
+
+int main()
+{
+    test_bin_roundtrip();
+    test_bin_checks();
+    test_json_roundtrip();
+    test_json_keys();
+    return test_result("payload");
+}
@@ -0,0 +1,93 @@
+#include "host_test.h"
+#include "rain_filter.h"
+
+// Origem sintética: devolve o traço em 'ctx' (ou nada, simulando ADC sem leitura)
+struct trace_t
+{
+    const uint16_t *data;
+    int len;
+};
+
+static int trace_read(void *ctx, uint16_t *buf, int n)
+{
+    const trace_t *t = (const trace_t *)ctx;
+    int got = t->len < n ? t->len : n;
+    for (int i = 0; i < got; ++i)
+        buf[i] = t->data[i];
+    return got;
+}
+
+static void test_median()
+{
+    uint16_t odd[] = {5, 1, 3};
+    CHECK(rain_filter_median(odd, 3) == 3);
+    uint16_t one[] = {42};
+    CHECK(rain_filter_median(one, 1) == 42);
+    CHECK(rain_filter_median(one, 0) == 0);
+}
+
+// Picos isolados (0 e 4095) na rajada não deslocam a mediana
+static void test_outlier_rejection()
+{
+    uint16_t burst[RAIN_BURST_LEN];
+    for (int i = 0; i < RAIN_BURST_LEN; ++i)
+        burst[i] = (uint16_t)(2000 + (i % 3)); // ruído de ±1 LSB
+    for (int i = 0; i < RAIN_BURST_LEN; i += 5)
+        burst[i] = (i & 1) ? RAIN_ADC_MAX : 0; // 7 picos
+    uint16_t m = rain_filter_median(burst, RAIN_BURST_LEN);
+    CHECK(m >= 2000 && m <= 2002);
+}
+
+static void test_moving_average()
+{
+    rain_filter_t f;
+    rain_filter_init(&f, rain_source_t{nullptr, nullptr});
+    CHECK(rain_filter_push(&f, 100) == 100);
+    CHECK(rain_filter_push(&f, 200) == 150);
+    CHECK(rain_filter_push(&f, 300) == 200);
+    CHECK(rain_filter_push(&f, 400) == 250);
+    // Janela cheia: a mais antiga (100) sai
+    CHECK(rain_filter_push(&f, 500) == 350);
+}
+
+static void test_raw_to_pct()
+{
+    CHECK(rain_raw_to_pct(RAIN_ADC_MAX) == 0); // seco
+    CHECK(rain_raw_to_pct(0) == 100);          // encharcado
+    CHECK(rain_raw_to_pct(RAIN_ADC_MAX / 2) == 51);
+    CHECK(rain_raw_to_pct(-10) == 100);
+    CHECK(rain_raw_to_pct(RAIN_ADC_MAX * 2) == 0);
+}
+
+static void test_acquire()
+{
+    uint16_t data[RAIN_BURST_LEN];
+    for (int i = 0; i < RAIN_BURST_LEN; ++i)
+        data[i] = (i == 7) ? 0 : RAIN_ADC_MAX; // um pico "molhado" na rajada seca
+    trace_t trace = {data, RAIN_BURST_LEN};
+    rain_filter_t f;
+    rain_filter_init(&f, rain_source_t{trace_read, &trace});
+    int raw = -1;
+    CHECK(rain_filter_acquire(&f, &raw) == 0);
+    CHECK(raw == RAIN_ADC_MAX);
+
+    // Origem sem amostras: erro, e a média móvel não é alterada
+    trace_t empty = {data, 0};
+    f.src.ctx = &empty;
+    CHECK(rain_filter_acquire(&f, &raw) == -1);
+    CHECK(f.filled == 1);
+
+    rain_filter_t none;
+    rain_filter_init(&none, rain_source_t{nullptr, nullptr});
+    CHECK(rain_filter_acquire(&none, nullptr) == -1);
+}
+
+int main()
+{
+    test_median();
+    test_outlier_rejection();
+    test_moving_average();
+    test_raw_to_pct();
+    test_acquire();
+    return test_result("rain_filter");
+}
@@ -3,6 +3,10 @@ let updateInterval = 5000; // Padrão 5s para combinar com o seletor
 let isPaused = false;
 let intervalId = null;
 let lastSeq = 0; // controle para evitar duplicar logs
+let logWindow = []; // últimos logs recebidos (base do gráfico de tráfego)
+const LOG_WINDOW_MAX = 1024; // igual a LOGBUF_MAX no firmware
+let eventSource = null; // canal SSE (/events); polling só como fallback
+let lastUptimeMs = 0;
 let mqttChart = null; // instância do gráfico
 let lastCfg = null; // configurações atuais
 
@@ -16,8 +20,46 @@ document.addEventListener('DOMContentLoaded', () => {
     // Tenta uma leitura imediata ao carregar
     fetchData();
     loadConfig();
+    connectEvents();
 });
 
+// --- Push via Server-Sent Events ---
+// Com o canal aberto o polling é suspenso; se cair, o EventSource
+// reconecta sozinho e o polling cobre o intervalo.
+function connectEvents() {
+    if (!window.EventSource) return;
+    eventSource = new EventSource('/events');
+
+    eventSource.onopen = () => {
+        if (intervalId) clearInterval(intervalId);
+        intervalId = null;
+        fetchData(); // ressincroniza logs perdidos durante a queda
+    };
+
+    eventSource.onerror = () => {
+        if (!intervalId) startDataLoop();
+    };
+
+    eventSource.addEventListener('telemetry', (ev) => {
+        if (isPaused) return;
+        const data = JSON.parse(ev.data);
+        lastUptimeMs = data.uptime_ms;
+        setConnectionStatus(data.wifi_connected);
+        updateStatusCards(data);
+        updateTrafficChart(logWindow, lastUptimeMs);
+    });
+
+    eventSource.addEventListener('log', (ev) => {
+        if (isPaused) return;
+        const entry = JSON.parse(ev.data);
+        if (typeof entry.seq !== 'number' || entry.seq <= lastSeq) return;
+        appendLogRows([entry], lastUptimeMs);
+        logWindow.push(entry);
+        if (logWindow.length > LOG_WINDOW_MAX) logWindow.shift();
+        lastSeq = entry.seq;
+    });
+}
+
 // --- Navegação (SPA) ---
 function navigate(pageId) {
     // Remove classe ativa de tudo
@@ -107,6 +149,11 @@ function updateTrafficChart(logs, uptimeMs) {
 // --- Core Loop de Dados ---
 function startDataLoop() {
     if (intervalId) clearInterval(intervalId);
+    // Canal SSE ativo dispensa o polling
+    if (eventSource && eventSource.readyState === EventSource.OPEN) {
+        intervalId = null;
+        return;
+    }
     intervalId = setInterval(fetchData, updateInterval);
 }
 
@@ -114,6 +161,8 @@ function togglePause() {
     isPaused = !isPaused;
     const icon = document.getElementById('pause-icon');
     icon.className = isPaused ? 'fa-solid fa-play' : 'fa-solid fa-pause';
+    // Eventos ignorados durante a pausa são recuperados por uma leitura completa
+    if (!isPaused) fetchData();
 }
 
 function updateIntervalTime() {
@@ -123,24 +172,30 @@ function updateIntervalTime() {
 }
 
 // --- Busca de Dados (Agora confiando 100% no Backend) ---
+// Uma única requisição traz status, alertas e os logs novos desde lastSeq
 async function fetchData() {
     if (isPaused) return;
 
     try {
-        // Atualiza cartões de status
-        const respStatus = await fetch('/status');
-        if (!respStatus.ok) throw new Error("Falha na API /status");
-        const statusData = await respStatus.json();
+        const resp = await fetch(`/api/snapshot?since=${lastSeq}`, { cache: 'no-store' });
+        if (!resp.ok) throw new Error("Falha na API /api/snapshot");
+        const snap = await resp.json();
+        const statusData = snap.status || {};
+        lastUptimeMs = statusData.uptime_ms;
         setConnectionStatus(statusData.wifi_connected);
         updateStatusCards(statusData);
 
-        // Busca logs da aplicação
-        const respLogs = await fetch('/logs');
-        if (respLogs.ok) {
-            const logs = await respLogs.json();
-            appendLogRows(logs, statusData.uptime_ms);
-            updateTrafficChart(logs, statusData.uptime_ms);
+        const logs = snap.logs || {};
+        // Cursor menor que o nosso: dispositivo reiniciou
+        if (typeof logs.head === 'number' && logs.head < lastSeq) {
+            lastSeq = 0;
+            logWindow = [];
         }
+        const entries = Array.isArray(logs.entries) ? logs.entries : [];
+        appendLogRows(entries, statusData.uptime_ms);
+        logWindow = logWindow.concat(entries).slice(-LOG_WINDOW_MAX);
+        if (typeof logs.head === 'number') lastSeq = logs.head;
+        updateTrafficChart(logWindow, statusData.uptime_ms);
 
     } catch (error) {
         // Se falhar, marcamos como desconectado e NÃO geramos dados falsos
@@ -266,7 +321,19 @@ function saveConfig() {
         topic: document.getElementById('conf_topic').value,
         qos: document.getElementById('conf_qos').value,
         user: document.getElementById('conf_user').value,
-        pass_mqtt: document.getElementById('conf_pass_mqtt').value
+        pass_mqtt: document.getElementById('conf_pass_mqtt').value,
+        batch_size: document.getElementById('conf_batch_size').value,
+        batch_max_s: document.getElementById('conf_batch_max_s').value,
+        payload_fmt: document.getElementById('conf_payload_fmt').value,
+        rbe_enabled: document.getElementById('conf_rbe_enabled').value,
+        db_temp: document.getElementById('conf_db_temp').value,
+        db_hum: document.getElementById('conf_db_hum').value,
+        db_rain: document.getElementById('conf_db_rain').value,
+        heartbeat_s: document.getElementById('conf_heartbeat_s').value,
+        alert_temp_mid: document.getElementById('conf_alert_temp_mid').value,
+        alert_temp_high: document.getElementById('conf_alert_temp_high').value,
+        alert_rain_mid: document.getElementById('conf_alert_rain_mid').value,
+        alert_rain_heavy: document.getElementById('conf_alert_rain_heavy').value
     };
 
     // Envia para o ESP32
@@ -324,6 +391,17 @@ async function loadConfig() {
         if (cfg.qos !== undefined) document.getElementById('conf_qos').value = cfg.qos;
         if (cfg.user !== undefined) document.getElementById('conf_user').value = cfg.user || '';
         if (cfg.pass_mqtt !== undefined) document.getElementById('conf_pass_mqtt').value = cfg.pass_mqtt || '';
+        if (cfg.batch_size !== undefined) document.getElementById('conf_batch_size').value = cfg.batch_size || 1;
+        if (cfg.batch_max_s !== undefined) document.getElementById('conf_batch_max_s').value = cfg.batch_max_s || 60;
+        if (cfg.payload_fmt !== undefined) document.getElementById('conf_payload_fmt').value = cfg.payload_fmt;
+        if (cfg.rbe_enabled !== undefined) document.getElementById('conf_rbe_enabled').value = cfg.rbe_enabled ? '1' : '0';
+        if (cfg.db_temp !== undefined) document.getElementById('conf_db_temp').value = cfg.db_temp;
+        if (cfg.db_hum !== undefined) document.getElementById('conf_db_hum').value = cfg.db_hum;
+        if (cfg.db_rain !== undefined) document.getElementById('conf_db_rain').value = cfg.db_rain;
+        if (cfg.heartbeat_s !== undefined) document.getElementById('conf_heartbeat_s').value = cfg.heartbeat_s;
+        ['alert_temp_mid', 'alert_temp_high', 'alert_rain_mid', 'alert_rain_heavy'].forEach(k => {
+            if (cfg[k] !== undefined) document.getElementById('conf_' + k).value = cfg[k];
+        });
 
         // Atualiza badges MQTT com base na config
         const badgeMqtt = document.getElementById('badge-mqtt');
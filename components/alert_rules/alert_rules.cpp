@@ -0,0 +1,121 @@
+#include "alert_rules.h"
+#include <math.h>
+#include <string.h>
+
+void alert_thresholds_default(alert_thresholds_t *th)
+{
+    th->temp_mid = ALERT_DEFAULT_TEMP_MID;
+    th->temp_high = ALERT_DEFAULT_TEMP_HIGH;
+    th->rain_mid = ALERT_DEFAULT_RAIN_MID;
+    th->rain_heavy = ALERT_DEFAULT_RAIN_HEAVY;
+}
+
+bool alert_thresholds_sanitize(alert_thresholds_t *th)
+{
+    bool ok = true;
+    if (!isfinite(th->temp_mid) || !isfinite(th->temp_high) || th->temp_high <= th->temp_mid)
+    {
+        th->temp_mid = ALERT_DEFAULT_TEMP_MID;
+        th->temp_high = ALERT_DEFAULT_TEMP_HIGH;
+        ok = false;
+    }
+    if (!isfinite(th->rain_mid) || !isfinite(th->rain_heavy) || th->rain_mid <= 0.0f ||
+        th->rain_heavy <= th->rain_mid)
+    {
+        th->rain_mid = ALERT_DEFAULT_RAIN_MID;
+        th->rain_heavy = ALERT_DEFAULT_RAIN_HEAVY;
+        ok = false;
+    }
+    return ok;
+}
+
+void alert_engine_init_rules(alert_engine_t *e, const alert_rule_t *rules, size_t n)
+{
+    memset(e, 0, sizeof(*e));
+    if (n > ALERT_RULES_MAX)
+        n = ALERT_RULES_MAX;
+    for (size_t i = 0; i < n; ++i)
+    {
+        e->rules[i] = rules[i];
+        if (e->rules[i].levels > ALERT_RULE_MAX_LEVELS)
+            e->rules[i].levels = ALERT_RULE_MAX_LEVELS;
+    }
+    e->count = (uint8_t)n;
+}
+
+void alert_engine_init(alert_engine_t *e, const alert_thresholds_t *th)
+{
+    alert_thresholds_t t = *th;
+    alert_thresholds_sanitize(&t);
+    const alert_rule_t rules[ALERT_RULE_COUNT] = {
+        {"temp", ALERT_IN_TEMP, 3, {0.0f, t.temp_mid, t.temp_high}, ALERT_TEMP_HYSTERESIS, ALERT_DWELL_MS,
+         {"normal", "media", "alta"}},
+        {"rain", ALERT_IN_RAIN, 3, {0.0f, t.rain_mid, t.rain_heavy}, ALERT_RAIN_HYSTERESIS, ALERT_DWELL_MS,
+         {"sem_chuva", "chuva_media", "chuva_forte"}},
+    };
+    alert_engine_init_rules(e, rules, ALERT_RULE_COUNT);
+}
+
+// Nível alvo a partir do atual: sobe pelos limiares de entrada e só desce
+// abaixo da banda de histerese de cada nível
+static uint8_t target_level(const alert_rule_t *r, uint8_t level, float v)
+{
+    while (level + 1 < r->levels && v >= r->enter[level + 1])
+        level++;
+    while (level > 0 && v < r->enter[level] - r->hysteresis)
+        level--;
+    return level;
+}
+
+uint32_t alert_engine_update(alert_engine_t *e, const float in[ALERT_IN_COUNT], int64_t now_ms)
+{
+    uint32_t changed = 0;
+    for (uint8_t i = 0; i < e->count; ++i)
+    {
+        const alert_rule_t *r = &e->rules[i];
+        alert_rule_state_t *s = &e->state[i];
+        float v = in[r->input];
+        if (isnan(v))
+            continue;
+
+        if (!s->primed)
+        {
+            s->primed = true;
+            s->level = s->pending = target_level(r, 0, v);
+            if (s->level != 0)
+                changed |= 1u << i;
+            continue;
+        }
+
+        uint8_t target = target_level(r, s->level, v);
+        if (target == s->level)
+        {
+            s->pending = s->level; // voltou antes do dwell: descarta o candidato
+            continue;
+        }
+        if (target != s->pending)
+        {
+            s->pending = target;
+            s->pending_since_ms = now_ms;
+        }
+        if (now_ms - s->pending_since_ms >= (int64_t)r->dwell_ms)
+        {
+            s->level = target;
+            s->transitions++;
+            changed |= 1u << i;
+        }
+    }
+    return changed;
+}
+
+uint8_t alert_engine_level(const alert_engine_t *e, size_t rule)
+{
+    return rule < e->count ? e->state[rule].level : 0;
+}
+
+const char *alert_engine_label(const alert_engine_t *e, size_t rule)
+{
+    if (rule >= e->count)
+        return "";
+    return e->rules[rule].labels[e->state[rule].level];
+}
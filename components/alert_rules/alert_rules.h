@@ -0,0 +1,96 @@
+#ifndef ALERT_RULES_H
+#define ALERT_RULES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Motor de alertas por tabela, compartilhado pelo publicador (LEDs) e pelo
+// assinante (dashboard). Cada regra observa uma grandeza e tem até
+// ALERT_RULE_MAX_LEVELS níveis (0 = normal):
+//  - subir ao nível i exige valor >= enter[i];
+//  - sair do nível i para baixo exige valor < enter[i] - hysteresis;
+//  - um nível novo só é confirmado após se manter por dwell_ms.
+// A primeira leitura define o nível direto (sem espera). A avaliação é
+// incremental, O(regras x níveis) por amostra e sem alocação. Tabelas têm
+// tamanho fixo; os limiares vêm da configuração em tempo de execução.
+
+#define ALERT_RULE_MAX_LEVELS 3
+#define ALERT_RULES_MAX 4
+
+// Limiares padrão (configuração ausente na NVS)
+#define ALERT_DEFAULT_TEMP_MID 25.0f   // °C
+#define ALERT_DEFAULT_TEMP_HIGH 30.0f  // °C
+#define ALERT_DEFAULT_RAIN_MID 10.0f   // %
+#define ALERT_DEFAULT_RAIN_HEAVY 50.0f // %
+
+// Bandas e permanência da tabela padrão (fixas em tempo de compilação)
+#define ALERT_TEMP_HYSTERESIS 0.5f // °C
+#define ALERT_RAIN_HYSTERESIS 3.0f // %
+#define ALERT_DWELL_MS 10000
+
+typedef enum {
+    ALERT_IN_TEMP = 0,
+    ALERT_IN_HUM = 1,
+    ALERT_IN_RAIN = 2,
+    ALERT_IN_COUNT
+} alert_input_t;
+
+// Regras da tabela padrão
+typedef enum {
+    ALERT_RULE_TEMP = 0, // normal / media / alta
+    ALERT_RULE_RAIN = 1, // sem_chuva / chuva_media / chuva_forte
+    ALERT_RULE_COUNT
+} alert_rule_id_t;
+
+typedef struct {
+    const char *name;
+    alert_input_t input;
+    uint8_t levels;                     // níveis usados (2..ALERT_RULE_MAX_LEVELS)
+    float enter[ALERT_RULE_MAX_LEVELS]; // enter[0] não é usado
+    float hysteresis;
+    uint32_t dwell_ms;
+    const char *labels[ALERT_RULE_MAX_LEVELS];
+} alert_rule_t;
+
+typedef struct {
+    bool primed;              // já recebeu uma leitura válida
+    uint8_t level;            // nível confirmado
+    uint8_t pending;          // candidato aguardando dwell_ms
+    int64_t pending_since_ms;
+    uint32_t transitions;     // mudanças confirmadas
+} alert_rule_state_t;
+
+typedef struct {
+    alert_rule_t rules[ALERT_RULES_MAX];
+    alert_rule_state_t state[ALERT_RULES_MAX];
+    uint8_t count;
+} alert_engine_t;
+
+typedef struct {
+    float temp_mid;
+    float temp_high;
+    float rain_mid;
+    float rain_heavy;
+} alert_thresholds_t;
+
+void alert_thresholds_default(alert_thresholds_t *th);
+
+// Corrige limiares fora de ordem (nível maior abaixo do menor) para os padrões.
+// Retorna false se algo foi corrigido.
+bool alert_thresholds_sanitize(alert_thresholds_t *th);
+
+// Tabela padrão (temperatura e chuva) com os limiares dados
+void alert_engine_init(alert_engine_t *e, const alert_thresholds_t *th);
+
+// Tabela arbitrária (até ALERT_RULES_MAX regras, copiadas)
+void alert_engine_init_rules(alert_engine_t *e, const alert_rule_t *rules, size_t n);
+
+// Avalia uma amostra; 'in' indexado por alert_input_t (NAN = ausente: a
+// regra mantém o estado). Retorna a máscara das regras que mudaram de nível.
+uint32_t alert_engine_update(alert_engine_t *e, const float in[ALERT_IN_COUNT], int64_t now_ms);
+
+uint8_t alert_engine_level(const alert_engine_t *e, size_t rule);
+const char *alert_engine_label(const alert_engine_t *e, size_t rule);
+
+#endif // ALERT_RULES_H
@@ -1,35 +1,106 @@
 #include "alerts.h"
+#include "alert_rules.h"
+#include "station-table.h"
+#include "esp_log.h"
+#include <math.h>
 
-Alerts AlertManager::evaluate(float temperature, float rainPct)
+static const char *TAG = "ALERTS";
+
+// Motor e relógio de uma estação. O relógio avança pelo intervalo entre
+// amostras no relógio delas (epoch da captura ou recebimento local). Quando
+// a base muda (publicador ganha/perde o SNTP), o intervalo vem do relógio
+// local, sem salto
+struct StationAlerts
 {
-    Alerts a;
-    if (temperature < 25.0f) a.temp = TEMP_NORMAL;
-    else if (temperature < 30.0f) a.temp = TEMP_MEDIA;
-    else a.temp = TEMP_ALTA;
+    alert_engine_t engine;
+    int64_t engineMs;
+    int64_t lastMs;
+    int64_t lastRecvMs;
+    bool lastEpoch;
+    bool started;
+};
+
+static alert_thresholds_t thresholds;
+static StationAlerts entries[AlertManager::kMaxStations];
+// Índice da StationTable -> entrada + 1 (0 = sem alertas)
+static uint8_t entryOf[StationTable::kCapacity];
+static size_t entriesUsed = 0;
 
-    if (rainPct < 10.0f) a.rain = RAIN_SEM;
-    else if (rainPct < 50.0f) a.rain = RAIN_MEDIA;
-    else a.rain = RAIN_FORTE;
+// Entrada da estação, criada no primeiro uso; nullptr se não houver vaga
+static StationAlerts *entryFor(int station, bool create)
+{
+    if (station < 0 || station >= (int)StationTable::kCapacity)
+        return nullptr;
+    int idx = (int)entryOf[station] - 1;
+    if (idx >= 0)
+        return &entries[idx];
+    if (!create || entriesUsed >= AlertManager::kMaxStations)
+        return nullptr;
+    StationAlerts *a = &entries[entriesUsed++];
+    *a = StationAlerts();
+    alert_engine_init(&a->engine, &thresholds);
+    entryOf[station] = (uint8_t)entriesUsed;
     return a;
 }
 
-const char* AlertManager::tempLabel(TemperatureAlert a)
+void AlertManager::configure(const AppConfig &config)
 {
-    switch (a) {
-        case TEMP_NORMAL: return "normal";
-        case TEMP_MEDIA: return "media";
-        case TEMP_ALTA: return "alta";
-        default: return "normal";
-    }
+    alert_thresholds_t th = {config.alert_temp_mid, config.alert_temp_high,
+                             config.alert_rain_mid, config.alert_rain_heavy};
+    if (!alert_thresholds_sanitize(&th))
+        ESP_LOGW(TAG, "Limiares de alerta invalidos; usando padrao");
+    thresholds = th;
+    for (size_t i = 0; i < entriesUsed; ++i)
+        alert_engine_init(&entries[i].engine, &thresholds);
+    ESP_LOGI(TAG, "Alertas: temp %.1f/%.1f C, chuva %.0f/%.0f %%",
+             th.temp_mid, th.temp_high, th.rain_mid, th.rain_heavy);
 }
 
-const char* AlertManager::rainLabel(RainAlert a)
+bool AlertManager::update(int station, const TelemetrySample &s, int64_t recvMs)
 {
-    switch (a) {
-        case RAIN_SEM: return "sem_chuva";
-        case RAIN_MEDIA: return "chuva_media";
-        case RAIN_FORTE: return "chuva_forte";
-        default: return "sem_chuva";
+    StationAlerts *a = entryFor(station, true);
+    if (!a)
+        return false;
+
+    bool epoch = s.epochMs != 0;
+    int64_t t = epoch ? (int64_t)s.epochMs : recvMs;
+    if (a->started)
+    {
+        int64_t delta = (epoch == a->lastEpoch) ? t - a->lastMs : recvMs - a->lastRecvMs;
+        if (delta > 0) // fora de ordem não volta o relógio
+            a->engineMs += delta;
     }
+    a->started = true;
+    a->lastMs = t;
+    a->lastRecvMs = recvMs;
+    a->lastEpoch = epoch;
+
+    float in[ALERT_IN_COUNT] = {s.tempValid ? s.temp : NAN, s.humValid ? s.hum : NAN,
+                                s.rainValid ? s.rain : NAN};
+    uint32_t changed = alert_engine_update(&a->engine, in, a->engineMs);
+    if (changed)
+        ESP_LOGI(TAG, "Alerta estacao %d -> temp: %s | chuva: %s", station, tempLabel(station), rainLabel(station));
+    return changed != 0;
+}
+
+const char *AlertManager::tempLabel(int station)
+{
+    StationAlerts *a = entryFor(station, false);
+    return a ? alert_engine_label(&a->engine, ALERT_RULE_TEMP) : "normal"; // sem amostras ainda
 }
 
+const char *AlertManager::rainLabel(int station)
+{
+    StationAlerts *a = entryFor(station, false);
+    return a ? alert_engine_label(&a->engine, ALERT_RULE_RAIN) : "sem_chuva";
+}
+
+const char *AlertManager::tempLabel()
+{
+    return tempLabel(StationTable::primary());
+}
+
+const char *AlertManager::rainLabel()
+{
+    return rainLabel(StationTable::primary());
+}
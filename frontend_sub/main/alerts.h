@@ -1,28 +1,34 @@
 #pragma once
+#include "app.config.h"
+#include "telemetry-codec.h"
+#include <stddef.h>
+#include <stdint.h>
 
-enum TemperatureAlert
-{
-    TEMP_NORMAL,
-    TEMP_MEDIA,
-    TEMP_ALTA
-};
-enum RainAlert
-{
-    RAIN_SEM,
-    RAIN_MEDIA,
-    RAIN_FORTE
-};
-
-struct Alerts
-{
-    TemperatureAlert temp;
-    RainAlert rain;
-};
-
+// Alertas do dashboard sobre o motor compartilhado com o publicador
+// (components/alert_rules). Avaliados a cada amostra recebida, com
+// histerese e permanência mínima; só a task MQTT chama update().
+// Cada estação (índice da StationTable) tem seu próprio motor, para que
+// leituras de estações diferentes não reiniciem a permanência umas das
+// outras; o dashboard (/api/dados, /ws) mostra a estação principal.
 class AlertManager
 {
 public:
-    static Alerts evaluate(float temperature, float rainPct);
-    static const char *tempLabel(TemperatureAlert a);
-    static const char *rainLabel(RainAlert a);
+    static constexpr size_t kMaxStations = 32; // estações com alertas (como LinkStats)
+
+    // Monta a tabela de regras com os limiares da configuração
+    static void configure(const AppConfig &config);
+    // Avalia uma amostra da estação (campos inválidos não alteram a regra).
+    // A permanência mínima conta pelo epoch_ms da captura quando o
+    // publicador está sincronizado; sem ele, pelo recebimento (recvMs,
+    // relógio local). Retorna true se algum nível mudou
+    static bool update(int station, const TelemetrySample &s, int64_t recvMs);
+
+    // Nível atual da estação: "normal" / "media" / "alta"
+    static const char *tempLabel(int station);
+    // Nível atual da estação: "sem_chuva" / "chuva_media" / "chuva_forte"
+    static const char *rainLabel(int station);
+
+    // Níveis da estação principal (StationTable::primary())
+    static const char *tempLabel();
+    static const char *rainLabel();
 };
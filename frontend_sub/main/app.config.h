@@ -1,6 +1,7 @@
 #pragma once
 #include <string.h>
 #include <stdint.h>
+#include "alert_rules.h"
 
 struct AppConfig
 {
@@ -14,4 +15,10 @@ struct AppConfig
     char mqtt_user[32] = "";
     char mqtt_pass[64] = "";
     int32_t mqtt_qos = 0;
+
+    // Limiares dos alertas (°C e % de chuva), iguais aos do publicador
+    float alert_temp_mid = ALERT_DEFAULT_TEMP_MID;
+    float alert_temp_high = ALERT_DEFAULT_TEMP_HIGH;
+    float alert_rain_mid = ALERT_DEFAULT_RAIN_MID;
+    float alert_rain_heavy = ALERT_DEFAULT_RAIN_HEAVY;
 };
@@ -1,4 +1,5 @@
 #include "config-manager.h"
+#include <math.h>
 
 static const char *TAG = "CONFIG_MGR";
 
@@ -40,6 +41,17 @@ void ConfigManager::load(AppConfig &config)
         nvs_get_i32(handle, "port", &config.mqtt_port);
         nvs_get_i32(handle, "qos", &config.mqtt_qos);
 
+        // Limiares de alerta em centésimos
+        int32_t centi;
+        if (nvs_get_i32(handle, "al_t1", &centi) == ESP_OK)
+            config.alert_temp_mid = centi / 100.0f;
+        if (nvs_get_i32(handle, "al_t2", &centi) == ESP_OK)
+            config.alert_temp_high = centi / 100.0f;
+        if (nvs_get_i32(handle, "al_r1", &centi) == ESP_OK)
+            config.alert_rain_mid = centi / 100.0f;
+        if (nvs_get_i32(handle, "al_r2", &centi) == ESP_OK)
+            config.alert_rain_heavy = centi / 100.0f;
+
         nvs_close(handle);
         ESP_LOGI(TAG, "Config carregada. SSID: %s, Broker: %s", config.ssid, config.mqtt_broker);
     }
@@ -62,6 +74,10 @@ void ConfigManager::save(const AppConfig &config)
         nvs_set_str(handle, "mqpass", config.mqtt_pass);
         nvs_set_i32(handle, "port", config.mqtt_port);
         nvs_set_i32(handle, "qos", config.mqtt_qos);
+        nvs_set_i32(handle, "al_t1", (int32_t)lroundf(config.alert_temp_mid * 100.0f));
+        nvs_set_i32(handle, "al_t2", (int32_t)lroundf(config.alert_temp_high * 100.0f));
+        nvs_set_i32(handle, "al_r1", (int32_t)lroundf(config.alert_rain_mid * 100.0f));
+        nvs_set_i32(handle, "al_r2", (int32_t)lroundf(config.alert_rain_heavy * 100.0f));
 
         nvs_commit(handle);
         nvs_close(handle);
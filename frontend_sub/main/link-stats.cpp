@@ -0,0 +1,250 @@
+#include "link-stats.h"
+#include "station-table.h"
+#include "time-sync.h"
+#include "metrics.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+static constexpr uint32_t kFirstBucketMs = 25;
+
+struct LinkCounters
+{
+    bool started;
+    uint16_t boot;      // boot atual do publicador
+    uint32_t highest;   // maior seq recebida neste boot
+    uint64_t window;    // bit i = highest - i já recebida
+    uint32_t received;  // amostras distintas
+    uint32_t lost;      // lacunas ainda não preenchidas
+    uint32_t duplicates;
+    uint32_t reordered; // chegaram depois de uma seq maior (dentro da janela)
+    uint32_t late;      // mais antigas que a janela: não dá para distinguir duplicata
+    uint32_t replayed;
+    uint32_t restarts;  // mudanças de boot
+    uint32_t noSeq;     // amostras sem seq (publicador antigo)
+    uint32_t latCount;
+    uint32_t latSkew;   // latência negativa: relógios fora de sincronia
+    uint64_t latSumMs;
+    uint32_t latMaxMs;
+    uint32_t hist[LinkStats::kLatencyBuckets];
+};
+
+struct LinkEntry
+{
+    std::atomic<uint32_t> seq{0}; // ímpar = escrita em andamento
+    LinkCounters c = {};
+};
+
+static LinkEntry entries[LinkStats::kMaxStations];
+// Índice da StationTable -> entrada + 1 (0 = sem contabilidade)
+static std::atomic<uint8_t> entryOf[StationTable::kCapacity];
+static size_t entriesUsed = 0;
+
+// Entrada da estação (criada no primeiro uso; só a task MQTT chama)
+static LinkEntry *entryFor(int station, bool &isNew)
+{
+    isNew = false;
+    if (station < 0 || station >= (int)StationTable::kCapacity)
+        return nullptr;
+    int idx = (int)entryOf[station].load(std::memory_order_relaxed) - 1;
+    if (idx < 0)
+    {
+        if (entriesUsed >= LinkStats::kMaxStations)
+            return nullptr;
+        idx = (int)entriesUsed++;
+        isNew = true;
+    }
+    return &entries[idx];
+}
+
+static void beginWrite(LinkEntry &e, uint32_t &seq)
+{
+    seq = e.seq.load(std::memory_order_relaxed);
+    e.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+static void endWrite(LinkEntry &e, uint32_t seq, int station, bool isNew)
+{
+    e.seq.store(seq + 2, std::memory_order_release);
+    if (isNew)
+        entryOf[station].store((uint8_t)(&e - entries + 1), std::memory_order_release);
+}
+
+static void trackSequence(LinkCounters &c, const TelemetrySample &s, bool replay)
+{
+    if (s.seq == 0)
+    {
+        c.noSeq++;
+        return;
+    }
+    if (replay)
+        c.replayed++;
+
+    if (!c.started || s.boot != c.boot)
+    {
+        // Reenvio de um boot anterior não reinicia a sequência atual
+        if (c.started && replay)
+            return;
+        if (c.started)
+            c.restarts++;
+        c.started = true;
+        c.boot = s.boot;
+        c.highest = s.seq;
+        c.window = 1;
+        c.received++;
+        return;
+    }
+
+    if (s.seq > c.highest)
+    {
+        uint32_t d = s.seq - c.highest;
+        c.lost += d - 1;
+        c.window = d >= LinkStats::kWindow ? 0 : c.window << d;
+        c.window |= 1;
+        c.highest = s.seq;
+        c.received++;
+        return;
+    }
+
+    uint32_t d = c.highest - s.seq;
+    if (d >= LinkStats::kWindow)
+    {
+        if (!replay)
+            c.late++;
+    }
+    else
+    {
+        uint64_t bit = 1ULL << d;
+        if (c.window & bit)
+        {
+            c.duplicates++;
+            return;
+        }
+        c.window |= bit;
+        if (!replay)
+            c.reordered++;
+    }
+    // Preenche uma lacuna contada antes
+    if (c.lost > 0)
+        c.lost--;
+    c.received++;
+}
+
+void LinkStats::record(int station, const TelemetrySample &s, bool replay)
+{
+    bool isNew;
+    LinkEntry *e = entryFor(station, isNew);
+    if (!e)
+        return;
+    uint32_t seq;
+    beginWrite(*e, seq);
+    trackSequence(e->c, s, replay);
+    endWrite(*e, seq, station, isNew);
+}
+
+static size_t latencyBucket(uint32_t ms)
+{
+    size_t i = 0;
+    uint32_t bound = kFirstBucketMs;
+    while (i < LinkStats::kLatencyBuckets - 1 && ms >= bound)
+    {
+        bound <<= 1;
+        ++i;
+    }
+    return i;
+}
+
+void LinkStats::latency(int station, uint64_t captureEpochMs)
+{
+    uint64_t now = TimeSync::nowEpochMs();
+    if (captureEpochMs == 0 || now == 0)
+        return;
+    bool isNew;
+    LinkEntry *e = entryFor(station, isNew);
+    if (!e)
+        return;
+    uint32_t seq;
+    beginWrite(*e, seq);
+    LinkCounters &c = e->c;
+    if (now < captureEpochMs)
+    {
+        c.latSkew++;
+    }
+    else
+    {
+        uint64_t d = now - captureEpochMs;
+        uint32_t ms = d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+        c.hist[latencyBucket(ms)]++;
+        c.latCount++;
+        c.latSumMs += ms;
+        if (ms > c.latMaxMs)
+            c.latMaxMs = ms;
+    }
+    endWrite(*e, seq, station, isNew);
+}
+
+static bool readEntry(const LinkEntry &e, LinkCounters &out)
+{
+    for (int attempt = 0; attempt < 8; ++attempt)
+    {
+        uint32_t s1 = e.seq.load(std::memory_order_acquire);
+        if (s1 & 1)
+            continue;
+        memcpy(&out, &e.c, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) == s1)
+            return true;
+    }
+    return false;
+}
+
+esp_err_t LinkStats::handler(httpd_req_t *req)
+{
+    Metrics::http(HttpEndpoint::Link);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    char item[512];
+    int n = snprintf(item, sizeof(item), "{\"synced\":%s,\"window\":%lu,\"buckets_ms\":[",
+                     TimeSync::synced() ? "true" : "false", (unsigned long)kWindow);
+    uint32_t bound = kFirstBucketMs;
+    for (size_t i = 0; i + 1 < kLatencyBuckets; ++i, bound <<= 1)
+        n += snprintf(item + n, sizeof(item) - n, "%s%lu", i ? "," : "", (unsigned long)bound);
+    n += snprintf(item + n, sizeof(item) - n, "],\"stations\":[");
+    esp_err_t ret = httpd_resp_send_chunk(req, item, (size_t)n);
+    bool first = true;
+
+    for (size_t station = 0; station < StationTable::kCapacity && ret == ESP_OK; ++station)
+    {
+        int idx = (int)entryOf[station].load(std::memory_order_acquire) - 1;
+        LinkCounters c;
+        if (idx < 0 || !readEntry(entries[idx], c))
+            continue;
+
+        n = snprintf(item, sizeof(item),
+                     "%s{\"id\":%u,\"boot\":%u,\"last_seq\":%lu,\"received\":%lu,\"lost\":%lu,"
+                     "\"duplicates\":%lu,\"reordered\":%lu,\"late\":%lu,\"replayed\":%lu,\"restarts\":%lu,"
+                     "\"no_seq\":%lu,\"latency\":{\"count\":%lu,\"skew\":%lu,\"avg_ms\":%lu,\"max_ms\":%lu,\"hist\":[",
+                     first ? "" : ",", (unsigned)station, (unsigned)c.boot, (unsigned long)c.highest,
+                     (unsigned long)c.received, (unsigned long)c.lost, (unsigned long)c.duplicates,
+                     (unsigned long)c.reordered, (unsigned long)c.late, (unsigned long)c.replayed,
+                     (unsigned long)c.restarts, (unsigned long)c.noSeq, (unsigned long)c.latCount,
+                     (unsigned long)c.latSkew, (unsigned long)(c.latCount ? c.latSumMs / c.latCount : 0),
+                     (unsigned long)c.latMaxMs);
+        for (size_t i = 0; i < kLatencyBuckets && n > 0 && n < (int)sizeof(item); ++i)
+            n += snprintf(item + n, sizeof(item) - n, "%s%lu", i ? "," : "", (unsigned long)c.hist[i]);
+        if (n > 0 && n < (int)sizeof(item))
+            n += snprintf(item + n, sizeof(item) - n, "]}}");
+        if (n <= 0 || n >= (int)sizeof(item))
+            continue;
+        ret = httpd_resp_send_chunk(req, item, (size_t)n);
+        first = false;
+    }
+
+    if (ret == ESP_OK)
+        ret = httpd_resp_send_chunk(req, "]}", 2);
+    if (ret != ESP_OK)
+        return ret;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
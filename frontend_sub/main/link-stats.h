@@ -0,0 +1,29 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+#include "telemetry-codec.h"
+
+// Contabilidade do enlace publicador -> broker -> assinante por estação,
+// a partir do seq/boot/epoch_ms de cada amostra:
+//  - perdas (lacunas na sequência), duplicatas e reordenação, com uma
+//    janela de kWindow sequências recentes em bitmap (O(1) por amostra);
+//  - histograma de latência captura -> recebimento da amostra mais nova de
+//    cada mensagem, quando os dois relógios estão sincronizados (SNTP).
+// Amostras reenviadas (replay) preenchem lacunas mas não entram na latência.
+class LinkStats
+{
+public:
+    static constexpr size_t kMaxStations = 32;
+    static constexpr uint32_t kWindow = 64;
+    static constexpr size_t kLatencyBuckets = 12; // 25 ms * 2^i, último = +Inf
+
+    // Registra uma amostra da estação (índice da StationTable)
+    static void record(int station, const TelemetrySample &s, bool replay);
+
+    // Latência da amostra mais nova de uma mensagem ao vivo
+    static void latency(int station, uint64_t captureEpochMs);
+
+    // GET /api/link: contadores e histograma de cada estação (JSON chunked)
+    static esp_err_t handler(httpd_req_t *req);
+};
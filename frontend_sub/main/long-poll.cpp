@@ -0,0 +1,107 @@
+#include "long-poll.h"
+#include "sensor-snapshot.h"
+#include "web-server.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "LONG_POLL";
+
+struct ParkedRequest
+{
+    httpd_req_t *req = nullptr; // nullptr = vaga livre
+    uint32_t after = 0;
+    int64_t deadlineUs = 0;
+};
+
+static ParkedRequest parked[LongPoll::kMaxParked];
+static SemaphoreHandle_t lock = nullptr;
+static TaskHandle_t taskHandle = nullptr;
+
+void LongPoll::start()
+{
+    lock = xSemaphoreCreateMutex();
+    xTaskCreate(task, "long_poll", 4096, NULL, tskIDLE_PRIORITY + 2, &taskHandle);
+}
+
+bool LongPoll::park(httpd_req_t *req, uint32_t after)
+{
+    if (!taskHandle)
+        return false;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    ParkedRequest *slot = nullptr;
+    for (auto &p : parked)
+    {
+        if (!p.req)
+        {
+            slot = &p;
+            break;
+        }
+    }
+    httpd_req_t *async = nullptr;
+    if (slot && httpd_req_async_handler_begin(req, &async) == ESP_OK)
+    {
+        slot->req = async;
+        slot->after = after;
+        slot->deadlineUs = esp_timer_get_time() + (int64_t)kTimeoutMs * 1000;
+    }
+    xSemaphoreGive(lock);
+    if (!async)
+        return false;
+
+    // Uma amostra pode ter chegado entre a checagem do handler e aqui:
+    // a task reavalia todas as vagas
+    xTaskNotifyGive(taskHandle);
+    return true;
+}
+
+void LongPoll::notify()
+{
+    if (taskHandle)
+        xTaskNotifyGive(taskHandle);
+}
+
+void LongPoll::task(void *arg)
+{
+    for (;;)
+    {
+        // Dorme até uma nova amostra ou até o prazo mais próximo
+        int64_t now = esp_timer_get_time();
+        int64_t next = now + (int64_t)kTimeoutMs * 1000;
+        xSemaphoreTake(lock, portMAX_DELAY);
+        for (auto &p : parked)
+        {
+            if (p.req && p.deadlineUs < next)
+                next = p.deadlineUs;
+        }
+        xSemaphoreGive(lock);
+        TickType_t wait = next > now ? pdMS_TO_TICKS((next - now) / 1000) + 1 : 0;
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        uint32_t version = SensorSnapshot::version();
+        now = esp_timer_get_time();
+        for (auto &p : parked)
+        {
+            // Retira da tabela sob o lock; o envio acontece fora dele
+            xSemaphoreTake(lock, portMAX_DELAY);
+            httpd_req_t *req = nullptr;
+            bool fresh = false;
+            if (p.req && (version != p.after || now >= p.deadlineUs))
+            {
+                req = p.req;
+                fresh = version != p.after;
+                p.req = nullptr;
+            }
+            xSemaphoreGive(lock);
+            if (!req)
+                continue;
+
+            if (WebServer::sendSnapshot(req, !fresh) != ESP_OK)
+                ESP_LOGW(TAG, "Cliente de long-poll desconectado");
+            httpd_req_async_handler_complete(req);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include "esp_http_server.h"
+
+// Long-poll de /api/dados?after=<versão>: a requisição é desacoplada do
+// httpd (httpd_req_async_handler_begin) e estacionada até surgir uma versão
+// diferente de 'after' (amostra nova ou reboot do dispositivo) ou até o
+// timeout (responde 304). Uma task própria envia as respostas, então nem o
+// httpd nem a task MQTT bloqueiam.
+class LongPoll
+{
+public:
+    static constexpr int kMaxParked = 3;          // cada uma ocupa um socket
+    static constexpr uint32_t kTimeoutMs = 25000; // abaixo do timeout típico de proxies
+
+    static void start();
+
+    // Estaciona 'req'; false se não há vaga (o chamador responde)
+    static bool park(httpd_req_t *req, uint32_t after);
+
+    // Chamado pela task MQTT após publicar um novo snapshot
+    static void notify();
+
+private:
+    static void task(void *arg);
+};
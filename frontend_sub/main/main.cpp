@@ -2,6 +2,9 @@
 #include "wifi.h"
 #include "web-server.h"
 #include "mqtt.h"
+#include "sensor-snapshot.h"
+#include "time-sync.h"
+#include "alerts.h"
 #include "esp_log.h"
 
 static const char *TAG = "MAIN";
@@ -12,15 +15,22 @@ extern "C" void app_main(void)
 
     // 1. Inicializa serviços base
     ConfigManager::init();
-    WebServer::mountSpiffs();
+    WebAssets::init();
 
     // 2. Carrega Configurações
     AppConfig config;
     ConfigManager::load(config);
+    AlertManager::configure(config);
 
     // 3. Inicia Wi-Fi
     WiFiManager::start(config);
 
+    // Relógio SNTP para medir a latência da telemetria (/api/link)
+    TimeSync::start();
+
+    // Snapshot inicial para /api/dados antes da task MQTT assumir a escrita
+    SensorSnapshot::publish();
+
     // 4. Inicia MQTT (se houver broker configurado)
     // Instanciamos aqui para manter o cliente vivo durante a execução
     static MqttManager mqtt;
@@ -0,0 +1,64 @@
+#include "message-assembler.h"
+#include <string.h>
+
+MessageAssembler::Result MessageAssembler::feed(const esp_mqtt_event_t *event, Message &msg)
+{
+    size_t offset = event->current_data_offset > 0 ? (size_t)event->current_data_offset : 0;
+    size_t chunk = event->data_len > 0 ? (size_t)event->data_len : 0;
+    size_t msgTotal = event->total_data_len > 0 ? (size_t)event->total_data_len : chunk;
+
+    // Caminho comum: mensagem inteira em um único evento
+    if (offset == 0 && chunk == msgTotal)
+    {
+        total = received = 0;
+        skipping = false;
+        msg.data = event->data;
+        msg.len = chunk;
+        msg.topic = event->topic;
+        msg.topicLen = event->topic_len > 0 ? (size_t)event->topic_len : 0;
+        return Result::Complete;
+    }
+
+    if (offset == 0)
+    {
+        // Primeiro fragmento: descarta qualquer remontagem incompleta
+        total = msgTotal;
+        received = 0;
+        topicLen = event->topic_len > 0 ? (size_t)event->topic_len : 0;
+        // Tópico longo demais: descarta em vez de truncar (viraria outra estação)
+        skipping = msgTotal > sizeof(buf) || topicLen > sizeof(topic);
+        if (skipping)
+            return Result::Dropped;
+        memcpy(topic, event->topic, topicLen);
+    }
+    else if (skipping)
+    {
+        if (offset + chunk >= total)
+        {
+            skipping = false;
+            total = 0;
+        }
+        return Result::Partial;
+    }
+    else if (total == 0 || offset != received || offset + chunk > total)
+    {
+        // Fragmento sem início conhecido ou fora de ordem: descarta o
+        // restante da mensagem (contado uma única vez)
+        total = msgTotal;
+        received = 0;
+        skipping = offset + chunk < msgTotal;
+        return Result::Dropped;
+    }
+
+    memcpy(buf + offset, event->data, chunk);
+    received = offset + chunk;
+    if (received < total)
+        return Result::Partial;
+
+    msg.data = buf;
+    msg.len = total;
+    msg.topic = topic;
+    msg.topicLen = topicLen;
+    total = received = 0;
+    return Result::Complete;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_client.h"
+
+// Remonta mensagens que o esp-mqtt entrega em vários MQTT_EVENT_DATA
+// (current_data_offset/total_data_len) num buffer fixo. Mensagens que
+// chegam inteiras não são copiadas: o ponteiro do evento é devolvido.
+class MessageAssembler
+{
+public:
+    static constexpr size_t kMaxMessage = 2048; // buffer do publicador
+    static constexpr size_t kMaxTopic = 64;
+
+    enum class Result : uint8_t
+    {
+        Complete, // 'msg' aponta para a mensagem inteira e seu tópico
+        Partial,  // aguardando os próximos fragmentos
+        Dropped,  // grande demais, tópico longo demais ou fragmento fora de ordem
+    };
+
+    struct Message
+    {
+        const char *data;
+        size_t len;
+        const char *topic;
+        size_t topicLen;
+    };
+
+    Result feed(const esp_mqtt_event_t *event, Message &msg);
+
+private:
+    char buf[kMaxMessage];
+    char topic[kMaxTopic];
+    size_t topicLen = 0;
+    size_t total = 0;    // tamanho esperado da mensagem em remontagem
+    size_t received = 0; // bytes já copiados
+    bool skipping = false; // descartando o restante de uma mensagem
+};
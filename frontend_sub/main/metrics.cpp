@@ -0,0 +1,132 @@
+#include "metrics.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+std::atomic<uint32_t> Metrics::counters[(size_t)Metric::Count];
+std::atomic<uint32_t> Metrics::httpRequests[(size_t)HttpEndpoint::Count];
+
+struct MetricDesc
+{
+    const char *name;
+    const char *help;
+};
+
+// Mesma ordem de Metric
+static const MetricDesc kMetrics[(size_t)Metric::Count] = {
+    {"monitor_mqtt_messages_total", "Mensagens MQTT recebidas"},
+    {"monitor_mqtt_samples_total", "Amostras aplicadas a partir das mensagens"},
+    {"monitor_mqtt_parse_errors_total", "Payloads MQTT invalidos"},
+    {"monitor_mqtt_connects_total", "Conexoes ao broker MQTT"},
+    {"monitor_mqtt_reconnects_total", "Conexoes ao broker apos uma queda"},
+    {"monitor_mqtt_disconnects_total", "Desconexoes do broker MQTT"},
+    {"monitor_ws_broadcasts_total", "Leituras enviadas ao feed ao vivo"},
+    {"monitor_stations_dropped_total", "Mensagens de estacoes novas descartadas (tabela cheia)"},
+    {"monitor_stations_topic_too_long_total", "Mensagens com topico longo demais para a tabela de estacoes"},
+};
+
+// Mesma ordem de HttpEndpoint
+static const char *kEndpoints[(size_t)HttpEndpoint::Count] = {
+    "/api/dados", "/api/config", "/ws", "/metrics", "/api/stations", "/api/history",
+    "/api/link", "static",
+};
+
+// Tasks cuja folga de stack é exportada
+static const char *kTasks[] = {"httpd", "mqtt_task", "tiT", "sys_evt", "esp_timer", "wifi"};
+
+// Acumula linhas e envia um chunk quando o buffer está quase cheio
+class MetricsWriter
+{
+public:
+    explicit MetricsWriter(httpd_req_t *req) : req(req) {}
+
+    void line(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char tmp[160];
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+        va_end(ap);
+        if (n <= 0)
+            return;
+        if ((size_t)n >= sizeof(tmp))
+            n = sizeof(tmp) - 1;
+        if (len + (size_t)n > sizeof(buf))
+            flush();
+        memcpy(buf + len, tmp, (size_t)n);
+        len += (size_t)n;
+    }
+
+    void header(const char *name, const char *help, const char *type)
+    {
+        line("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void gauge(const char *name, const char *help, unsigned long v)
+    {
+        header(name, help, "gauge");
+        line("%s %lu\n", name, v);
+    }
+
+    esp_err_t finish()
+    {
+        flush();
+        if (err != ESP_OK)
+            return err;
+        return httpd_resp_send_chunk(req, NULL, 0);
+    }
+
+private:
+    void flush()
+    {
+        if (err == ESP_OK && len > 0)
+            err = httpd_resp_send_chunk(req, buf, len);
+        len = 0;
+    }
+
+    httpd_req_t *req;
+    char buf[512];
+    size_t len = 0;
+    esp_err_t err = ESP_OK;
+};
+
+esp_err_t Metrics::handler(httpd_req_t *req)
+{
+    http(HttpEndpoint::Metrics);
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    MetricsWriter w(req);
+    for (size_t i = 0; i < (size_t)Metric::Count; ++i)
+    {
+        w.header(kMetrics[i].name, kMetrics[i].help, "counter");
+        w.line("%s %lu\n", kMetrics[i].name, (unsigned long)counters[i].load(std::memory_order_relaxed));
+    }
+
+    w.header("monitor_http_requests_total", "Requisicoes HTTP por endpoint", "counter");
+    for (size_t i = 0; i < (size_t)HttpEndpoint::Count; ++i)
+        w.line("monitor_http_requests_total{endpoint=\"%s\"} %lu\n", kEndpoints[i],
+               (unsigned long)httpRequests[i].load(std::memory_order_relaxed));
+
+    w.gauge("monitor_uptime_seconds", "Tempo desde o boot", (unsigned long)(esp_timer_get_time() / 1000000LL));
+    w.gauge("monitor_heap_free_bytes", "Heap livre", (unsigned long)esp_get_free_heap_size());
+    w.gauge("monitor_heap_min_free_bytes", "Menor heap livre desde o boot",
+            (unsigned long)esp_get_minimum_free_heap_size());
+    w.gauge("monitor_heap_largest_free_block_bytes", "Maior bloco livre (fragmentacao)",
+            (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+
+    w.header("monitor_task_stack_free_min_bytes", "Menor folga de stack da task desde o boot", "gauge");
+    for (const char *name : kTasks)
+    {
+        TaskHandle_t h = xTaskGetHandle(name);
+        if (h)
+            w.line("monitor_task_stack_free_min_bytes{task=\"%s\"} %lu\n", name,
+                   (unsigned long)uxTaskGetStackHighWaterMark(h));
+    }
+    return w.finish();
+}
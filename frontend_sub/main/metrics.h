@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "esp_http_server.h"
+
+// Contadores para o endpoint /metrics (formato de texto do Prometheus).
+// Cada incremento é um fetch_add relaxado, sem lock: pode ser chamado do
+// handler de eventos MQTT e dos handlers HTTP sem custo perceptível.
+enum class Metric : uint8_t
+{
+    MqttReceived,    // mensagens recebidas no tópico
+    MqttSamples,     // amostras aplicadas (um lote conta várias)
+    MqttParseErrors, // payloads inválidos (JSON ou binário)
+    MqttConnects,
+    MqttReconnects,  // conexões após uma queda
+    MqttDisconnects,
+    WsBroadcasts,    // leituras enviadas ao feed ao vivo
+    StationsDropped, // mensagens de estações novas com a tabela cheia
+    StationsTopicTooLong, // mensagens com tópico maior que StationTable::kTopicLen
+    Count
+};
+
+enum class HttpEndpoint : uint8_t
+{
+    Data,
+    Config,
+    Ws,
+    Metrics,
+    Stations,
+    History,
+    Link,
+    Static,
+    Count
+};
+
+class Metrics
+{
+public:
+    static void inc(Metric m, uint32_t n = 1)
+    {
+        counters[(size_t)m].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static uint32_t get(Metric m)
+    {
+        return counters[(size_t)m].load(std::memory_order_relaxed);
+    }
+
+    static void http(HttpEndpoint ep)
+    {
+        httpRequests[(size_t)ep].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Handler de GET /metrics: contadores, heap e stack mínima das tasks
+    static esp_err_t handler(httpd_req_t *req);
+
+private:
+    static std::atomic<uint32_t> counters[(size_t)Metric::Count];
+    static std::atomic<uint32_t> httpRequests[(size_t)HttpEndpoint::Count];
+};
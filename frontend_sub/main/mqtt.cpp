@@ -1,11 +1,154 @@
 #include "mqtt.h"
 #include "SensorData.h"
+#include "telemetry-codec.h"
+#include "web-server.h"
+#include "metrics.h"
+#include "sensor-snapshot.h"
+#include "long-poll.h"
+#include "station-table.h"
+#include "station-history.h"
+#include "link-stats.h"
+#include "alerts.h"
+#include "time-sync.h"
+#include "esp_timer.h"
 #include "esp_log.h"
-#include "cJSON.h"
-#include <string.h> // Necessário para memcpy
+#include <string.h>
 
 static const char *TAG = "MQTT_MGR";
 
+// Instante da captura em s de uptime local, para o histórico: pelo epoch_ms
+// quando os dois relógios estão sincronizados; senão pelo ts_ms relativo à
+// amostra mais nova da mensagem (refTsMs), que chega agora
+static uint32_t captureUptimeS(const TelemetrySample &s, uint32_t refTsMs, int64_t nowMs)
+{
+    int64_t age = 0;
+    uint64_t nowEpoch = TimeSync::nowEpochMs();
+    if (s.epochMs && nowEpoch)
+        age = nowEpoch > s.epochMs ? (int64_t)(nowEpoch - s.epochMs) : 0;
+    else if (s.ts_ms && refTsMs >= s.ts_ms)
+        age = (int64_t)(refTsMs - s.ts_ms);
+    return (uint32_t)((age < nowMs ? nowMs - age : 0) / 1000);
+}
+
+// Acumula em 'latest' a leitura mais recente da estação; a struct Global
+// (Back do Back) só acompanha a estação principal. Cada amostra de um lote
+// entra no histórico no balde da sua captura
+static void applySample(int station, const TelemetrySample &s, uint32_t refTsMs, TelemetrySample &latest)
+{
+    bool primary = station >= 0 && station == StationTable::primary();
+    if (s.tempValid)
+        latest.temp = s.temp;
+    if (s.humValid)
+        latest.hum = s.hum;
+    if (s.rainValid)
+        latest.rain = s.rain;
+    latest.tempValid |= s.tempValid;
+    latest.humValid |= s.humValid;
+    latest.rainValid |= s.rainValid;
+    latest.epochMs = s.epochMs; // amostras em ordem de captura
+    if (primary)
+    {
+        if (s.tempValid)
+            globalSensorData.temp = s.temp;
+        if (s.humValid)
+            globalSensorData.hum = s.hum;
+        if (s.rainValid)
+            globalSensorData.rain = s.rain;
+    }
+    // Alertas avaliados a cada amostra (não a cada snapshot), no motor da
+    // estação; a permanência mínima conta pela captura (epoch_ms) ou, sem
+    // SNTP, pela recepção
+    int64_t nowMs = esp_timer_get_time() / 1000;
+    AlertManager::update(station, s, nowMs);
+    StationHistory::add(station, s, captureUptimeS(s, refTsMs, nowMs));
+    LinkStats::record(station, s, false);
+    Metrics::inc(Metric::MqttSamples);
+}
+
+// Nova leitura aplicada: atualiza a estação de origem e a latência (uma
+// vez por mensagem). Se for a estação principal, serializa o snapshot e
+// avisa o feed ao vivo e os long-polls
+static void samplesApplied(int station, const TelemetrySample &latest)
+{
+    StationTable::update(station, latest);
+    LinkStats::latency(station, latest.epochMs);
+    if (station < 0 || station != StationTable::primary())
+        return;
+    SensorSnapshot::publish();
+    WebServer::broadcastSample();
+    LongPoll::notify();
+}
+
+// Decodifica uma mensagem completa (binária ou JSON) sem usar o heap.
+// Lotes reenviados (replay) trazem amostras antigas: não substituem a leitura
+// atual, só preenchem lacunas na contabilidade do enlace.
+// Com tópico curinga, a leitura "atual" é a da estação principal
+// (StationTable::primary); as demais ficam em /api/stations
+static void handleTelemetry(const MessageAssembler::Message &msg)
+{
+    const char *data = msg.data;
+    size_t len = msg.len;
+    int station = StationTable::slot(msg.topic, msg.topicLen);
+    TelemetrySample latest;
+    // Payload binário compacto: decodifica direto do buffer
+    int n = TelemetryCodec::binarySampleCount(data, len);
+    if (n >= 0)
+    {
+        bool replay = TelemetryCodec::isReplay(data, len);
+        TelemetrySample s;
+        uint32_t refTsMs = n > 0 && TelemetryCodec::decodeSample(data, len, n - 1, s) ? s.ts_ms : 0;
+        int applied = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (!TelemetryCodec::decodeSample(data, len, i, s))
+            {
+                Metrics::inc(Metric::MqttParseErrors);
+                break;
+            }
+            if (replay)
+                LinkStats::record(station, s, true);
+            else
+                applySample(station, s, refTsMs, latest);
+            applied++;
+        }
+        if (replay)
+        {
+            ESP_LOGI(TAG, "Lote reenviado (binario, %d amostra(s)) ignorado para leitura atual", applied);
+            return;
+        }
+        // Lote vazio ou primeira amostra inválida: nada mudou
+        if (applied == 0)
+            return;
+        ESP_LOGI(TAG, "Dados Atualizados (estacao %d, binario, %d amostra(s)) -> Temp: %.2f | Hum: %.2f | Rain: %.0f",
+                 station, applied, latest.temp, latest.hum, latest.rain);
+        samplesApplied(station, latest);
+        return;
+    }
+
+    static TelemetryBatch batch; // só a task MQTT chama; fora da stack
+    if (len == 0 || !TelemetryCodec::parseJson(data, len, batch))
+    {
+        ESP_LOGW(TAG, "JSON Inválido Recebido");
+        Metrics::inc(Metric::MqttParseErrors);
+        return;
+    }
+    if (batch.replay)
+    {
+        for (int i = 0; i < batch.count; ++i)
+            LinkStats::record(station, batch.samples[i], true);
+        ESP_LOGI(TAG, "Lote reenviado ignorado para leitura atual");
+        return;
+    }
+    // Lote aplicado em ordem de captura
+    uint32_t refTsMs = batch.count > 0 ? batch.samples[batch.count - 1].ts_ms : 0;
+    for (int i = 0; i < batch.count; ++i)
+        applySample(station, batch.samples[i], refTsMs, latest);
+    ESP_LOGI(TAG, "Dados Atualizados (estacao %d) -> Temp: %.2f | Hum: %.2f | Rain: %.0f",
+             station, latest.temp, latest.hum, latest.rain);
+    if (batch.count > 0)
+        samplesApplied(station, latest);
+}
+
 void MqttManager::event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
 {
     esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)event_data;
@@ -15,64 +158,40 @@ void MqttManager::event_handler(void *handler_args, esp_event_base_t base, int32
     {
     case MQTT_EVENT_CONNECTED:
         ESP_LOGI(TAG, "MQTT Conectado ao Broker!");
-        // Faz a subscrição automática usando o tópico e QoS da config
+        if (Metrics::get(Metric::MqttConnects) > 0)
+            Metrics::inc(Metric::MqttReconnects);
+        Metrics::inc(Metric::MqttConnects);
+        // Faz a subscrição automática usando o tópico e QoS da config.
+        // Curingas (esp/+/sensors) agregam várias estações em /api/stations
         esp_mqtt_client_subscribe(self->client, self->topic, self->qos);
         ESP_LOGI(TAG, "Inscrito no topico: %s com QoS: %d", self->topic, self->qos);
         break;
 
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(TAG, "MQTT Desconectado. Tentando reconectar automaticamente...");
+        Metrics::inc(Metric::MqttDisconnects);
         break;
 
     case MQTT_EVENT_DATA:
-        ESP_LOGI(TAG, "Mensagem recebida no topico %.*s", event->topic_len, event->topic);
+    {
+        // O tópico só vem no primeiro fragmento
+        if (event->current_data_offset == 0)
+            ESP_LOGI(TAG, "Mensagem recebida no topico %.*s", event->topic_len, event->topic);
 
-        if (event->data_len > 0)
+        MessageAssembler::Message msg;
+        MessageAssembler::Result r = self->assembler.feed(event, msg);
+        if (r == MessageAssembler::Result::Dropped)
         {
-            char *buffer = (char *)malloc(event->data_len + 1);
-            if (buffer == NULL)
-            {
-                ESP_LOGE(TAG, "Falha de memoria ao processar payload MQTT");
-                return;
-            }
-
-            // 2. Copia os dados brutos para o buffer e fecha a string
-            memcpy(buffer, event->data, event->data_len);
-            buffer[event->data_len] = '\0';
-
-            // printf("Payload JSON recebido: %s\n", buffer); // Descomente para debug
-
-            // 3. Faz o Parse do JSON
-            cJSON *root = cJSON_Parse(buffer);
-            if (root)
-            {
-                // 4. Busca os itens dentro do JSON com segurança
-                cJSON *t = cJSON_GetObjectItem(root, "dht_temp");
-                cJSON *h = cJSON_GetObjectItem(root, "dht_hum");
-                cJSON *p = cJSON_GetObjectItem(root, "rain_pct");
-
-                // 5. Atualiza a struct Global (Back do Back)
-                // Verifica se o campo existe e é número antes de atribuir
-                if (cJSON_IsNumber(t))
-                    globalSensorData.temp = (float)t->valuedouble;
-                if (cJSON_IsNumber(h))
-                    globalSensorData.hum = (float)h->valuedouble;
-                if (cJSON_IsNumber(p))
-                    globalSensorData.rain = (float)p->valuedouble;
-
-                ESP_LOGI(TAG, "Dados Atualizados -> Temp: %.2f | Hum: %.2f | Rain: %d",
-                         globalSensorData.temp, globalSensorData.hum, globalSensorData.rain);
-
-                cJSON_Delete(root); // Limpa o objeto JSON da memória RAM
-            }
-            else
-            {
-                ESP_LOGW(TAG, "JSON Inválido Recebido");
-            }
-
-            free(buffer); // IMPORTANTE: Libera a memória do buffer temporário
+            ESP_LOGW(TAG, "Mensagem fragmentada descartada (total %d bytes)", event->total_data_len);
+            Metrics::inc(Metric::MqttParseErrors);
+            break;
         }
+        if (r == MessageAssembler::Result::Partial)
+            break;
+        Metrics::inc(Metric::MqttReceived);
+        handleTelemetry(msg);
         break;
+    }
 
     case MQTT_EVENT_ERROR:
         ESP_LOGE(TAG, "Erro MQTT");
@@ -1,6 +1,7 @@
 #pragma once
 #include "app.config.h"
 #include "mqtt_client.h"
+#include "message-assembler.h"
 
 class MqttManager
 {
@@ -8,6 +9,7 @@ private:
     esp_mqtt_client_handle_t client = nullptr;
     char topic[64];
     int qos;
+    MessageAssembler assembler; // remonta mensagens fragmentadas
 
     static void event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data);
 
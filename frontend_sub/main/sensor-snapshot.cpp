@@ -0,0 +1,83 @@
+#include "sensor-snapshot.h"
+#include "SensorData.h"
+#include "alerts.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+struct SnapshotSlot
+{
+    std::atomic<uint32_t> seq{0}; // ímpar = escrita em andamento
+    uint32_t version = 0;
+    uint16_t len = 0;
+    char data[SensorSnapshot::kMaxLen];
+};
+
+static SnapshotSlot slots[2];
+static std::atomic<uint32_t> current{0}; // última versão publicada (0 = nenhuma)
+
+void SensorSnapshot::publish()
+{
+    float temp = globalSensorData.temp;
+    float hum = globalSensorData.hum;
+    float rain = globalSensorData.rain;
+
+    uint32_t v = current.load(std::memory_order_relaxed) + 1;
+    if (v == 0) // 0 é reservado para "sem snapshot"
+        v = 1;
+    SnapshotSlot &slot = slots[v & 1];
+
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    int n = snprintf(slot.data, sizeof(slot.data),
+                     "{\"version\":%lu,\"temp\":%.2f,\"hum\":%.2f,\"rain\":%.1f,\"alerts\":{\"temp\":\"%s\",\"rain\":\"%s\"}}",
+                     (unsigned long)v, temp, hum, rain,
+                     AlertManager::tempLabel(), AlertManager::rainLabel());
+    slot.len = (n > 0 && n < (int)sizeof(slot.data)) ? (uint16_t)n : 0;
+    slot.version = v;
+
+    slot.seq.store(seq + 2, std::memory_order_release);
+    current.store(v, std::memory_order_release);
+}
+
+size_t SensorSnapshot::read(char *out, size_t cap, uint32_t &version)
+{
+    for (;;)
+    {
+        uint32_t v = current.load(std::memory_order_acquire);
+        if (v == 0 || cap == 0)
+        {
+            version = 0;
+            return 0;
+        }
+        const SnapshotSlot &slot = slots[v & 1];
+        uint32_t s1 = slot.seq.load(std::memory_order_acquire);
+        if (s1 & 1)
+            continue; // escritor já está reutilizando este buffer
+
+        size_t len = slot.len;
+        if (len >= cap)
+            len = cap - 1;
+        memcpy(out, slot.data, len);
+        uint32_t slotVersion = slot.version;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != s1)
+            continue;
+        out[len] = '\0';
+        version = slotVersion;
+        return len;
+    }
+}
+
+uint32_t SensorSnapshot::version()
+{
+    return current.load(std::memory_order_acquire);
+}
+
+void SensorSnapshot::etag(uint32_t version, char *out, size_t cap)
+{
+    snprintf(out, cap, "\"v%lu\"", (unsigned long)version);
+}
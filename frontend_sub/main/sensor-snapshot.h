@@ -0,0 +1,27 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Resposta de /api/dados serializada uma vez por amostra recebida.
+// Dois buffers alternados protegidos por seqlock: a task MQTT (único
+// escritor) grava no buffer inativo e publica a nova versão; os handlers
+// copiam o JSON sem lock e sem alocação, repetindo se a cópia coincidir
+// com uma escrita.
+class SensorSnapshot
+{
+public:
+    static constexpr size_t kMaxLen = 192;
+
+    // Serializa globalSensorData e os níveis de alerta atuais numa nova versão.
+    // Chamar apenas do escritor (task MQTT, ou app_main antes dela iniciar).
+    static void publish();
+
+    // Copia o JSON atual para 'out' (terminado em '\0'); devolve o tamanho
+    // e a versão correspondente. 0 se nada foi publicado ainda.
+    static size_t read(char *out, size_t cap, uint32_t &version);
+
+    static uint32_t version();
+
+    // ETag forte da versão: "\"v<versão>\""
+    static void etag(uint32_t version, char *out, size_t cap);
+};
@@ -0,0 +1,234 @@
+#include "station-history.h"
+#include "station-table.h"
+#include "metrics.h"
+#include "esp_timer.h"
+#include <atomic>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct __attribute__((packed)) HistoryPoint
+{
+    int16_t temp;
+    uint8_t hum;
+    uint8_t rain;
+};
+
+struct TierDesc
+{
+    const char *name;
+    uint32_t periodS;
+    uint16_t len;
+};
+
+static constexpr size_t kTiers = 3;
+static constexpr uint16_t kMaxTierLen = 144;
+static const TierDesc kTierDesc[kTiers] = {
+    {"15m", 10, 90},
+    {"2h", 60, 120},
+    {"24h", 600, 144},
+};
+
+// Balde em formação: somas em ponto fixo das amostras recebidas
+struct Accum
+{
+    int32_t temp, hum, rain;
+    uint16_t nTemp, nHum, nRain;
+};
+
+struct Tier
+{
+    HistoryPoint points[kMaxTierLen]; // anel indexado por balde % len
+    uint32_t lastBucket;
+    Accum acc;
+};
+
+struct Series
+{
+    std::atomic<uint32_t> seq{0}; // ímpar = escrita em andamento
+    bool started = false;
+    Tier tiers[kTiers];
+};
+
+static Series series[StationHistory::kMaxStations];
+// Índice da StationTable -> série + 1 (0 = sem histórico). Publicado só
+// depois da primeira amostra da série
+static std::atomic<uint8_t> seriesOf[StationTable::kCapacity];
+static size_t seriesUsed = 0;
+
+static uint32_t nowS()
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+static const HistoryPoint kEmpty = {StationHistory::kTempNone, StationHistory::kPctNone, StationHistory::kPctNone};
+
+static uint8_t toPct(int32_t sum, uint16_t n)
+{
+    if (n == 0)
+        return StationHistory::kPctNone;
+    int32_t v = (sum + n / 2) / n;
+    return (uint8_t)(v < 0 ? 0 : (v > 100 ? 100 : v));
+}
+
+// Adiciona a amostra ao balde do instante 'at' no nível; baldes pulados
+// (sem amostras) ficam vazios. Baldes já fechados não são reabertos: uma
+// amostra mais antiga que o balde atual entra nele
+static void tierAdd(Tier &t, const TierDesc &d, uint32_t at, const TelemetrySample &s, bool first)
+{
+    uint32_t bucket = at / d.periodS;
+    if (!first && bucket < t.lastBucket)
+        bucket = t.lastBucket;
+    if (first || bucket - t.lastBucket >= d.len)
+    {
+        for (uint16_t i = 0; i < d.len; ++i)
+            t.points[i] = kEmpty;
+    }
+    else
+    {
+        for (uint32_t b = t.lastBucket + 1; b <= bucket; ++b)
+            t.points[b % d.len] = kEmpty;
+    }
+    if (first || bucket != t.lastBucket)
+    {
+        t.lastBucket = bucket;
+        memset(&t.acc, 0, sizeof(t.acc));
+    }
+
+    Accum &a = t.acc;
+    if (s.tempValid && a.nTemp < UINT16_MAX)
+    {
+        a.temp += (int32_t)lroundf(s.temp * 10.0f);
+        a.nTemp++;
+    }
+    if (s.humValid && a.nHum < UINT16_MAX)
+    {
+        a.hum += (int32_t)lroundf(s.hum);
+        a.nHum++;
+    }
+    if (s.rainValid && a.nRain < UINT16_MAX)
+    {
+        a.rain += (int32_t)lroundf(s.rain);
+        a.nRain++;
+    }
+
+    HistoryPoint &p = t.points[bucket % d.len];
+    if (a.nTemp)
+    {
+        int32_t v = a.temp / a.nTemp;
+        p.temp = (int16_t)(v < -32767 ? -32767 : (v > 32767 ? 32767 : v));
+    }
+    p.hum = toPct(a.hum, a.nHum);
+    p.rain = toPct(a.rain, a.nRain);
+}
+
+void StationHistory::add(int station, const TelemetrySample &s, uint32_t captureS)
+{
+    if (station < 0 || station >= (int)StationTable::kCapacity)
+        return;
+    // Só a task MQTT escreve
+    int idx = (int)seriesOf[station].load(std::memory_order_relaxed) - 1;
+    bool isNew = idx < 0;
+    if (isNew)
+    {
+        if (seriesUsed >= kMaxStations)
+            return;
+        idx = (int)seriesUsed++;
+    }
+
+    Series &sr = series[idx];
+    uint32_t now = nowS();
+    uint32_t at = captureS < now ? captureS : now;
+    uint32_t seq = sr.seq.load(std::memory_order_relaxed);
+    sr.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kTiers; ++i)
+        tierAdd(sr.tiers[i], kTierDesc[i], at, s, !sr.started);
+    sr.started = true;
+    sr.seq.store(seq + 2, std::memory_order_release);
+    if (isNew)
+        seriesOf[station].store((uint8_t)(idx + 1), std::memory_order_release);
+}
+
+// Resposta: cabeçalho de 16 B + até kMaxTierLen pontos
+struct __attribute__((packed)) HistoryReply
+{
+    uint8_t version;
+    uint8_t tier;
+    uint16_t count;
+    uint32_t periodS;
+    uint32_t nowS;
+    uint32_t lastBucketS;
+    HistoryPoint points[kMaxTierLen];
+};
+
+// Copia o nível em ordem cronológica sob o seqlock da série
+static bool readTier(const Series &sr, size_t tier, HistoryReply &out)
+{
+    const TierDesc &d = kTierDesc[tier];
+    for (int attempt = 0; attempt < 8; ++attempt)
+    {
+        uint32_t s1 = sr.seq.load(std::memory_order_acquire);
+        if (s1 & 1)
+            continue;
+        const Tier &t = sr.tiers[tier];
+        uint32_t last = t.lastBucket;
+        for (uint16_t i = 0; i < d.len; ++i)
+            out.points[i] = t.points[(last + 1 + i) % d.len];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sr.seq.load(std::memory_order_relaxed) == s1)
+        {
+            out.lastBucketS = last * d.periodS;
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t StationHistory::handler(httpd_req_t *req)
+{
+    Metrics::http(HttpEndpoint::History);
+
+    size_t tier = 0;
+    int station = StationTable::primary();
+    char query[64];
+    char val[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        if (httpd_query_key_value(query, "range", val, sizeof(val)) == ESP_OK)
+        {
+            tier = kTiers;
+            for (size_t i = 0; i < kTiers; ++i)
+                if (strcmp(val, kTierDesc[i].name) == 0)
+                    tier = i;
+            if (tier == kTiers)
+                return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "range: 15m, 2h ou 24h");
+        }
+        if (httpd_query_key_value(query, "station", val, sizeof(val)) == ESP_OK)
+            station = atoi(val);
+    }
+
+    int idx = -1;
+    if (station >= 0 && station < (int)StationTable::kCapacity)
+        idx = (int)seriesOf[station].load(std::memory_order_acquire) - 1;
+    if (idx < 0)
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Sem historico para a estacao");
+
+    static HistoryReply reply; // handlers HTTP rodam em uma única task
+    const TierDesc &d = kTierDesc[tier];
+    if (!readTier(series[idx], tier, reply))
+    {
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Historico ocupado");
+    }
+    reply.version = 1;
+    reply.tier = (uint8_t)tier;
+    reply.count = d.len;
+    reply.periodS = d.periodS;
+    reply.nowS = nowS();
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    size_t len = offsetof(HistoryReply, points) + (size_t)d.len * sizeof(HistoryPoint);
+    return httpd_resp_send(req, (const char *)&reply, len);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+#include "telemetry-codec.h"
+
+// Histórico por estação em memória fixa, para o dashboard carregar os
+// gráficos de uma vez em vez de reconstruí-los pelo polling. Cada estação
+// tem três níveis de baldes de período fixo (média das amostras do balde),
+// atualizados em O(1) por amostra:
+//   15m: 90 x 10 s    2h: 120 x 1 min    24h: 144 x 10 min
+// Ponto compacto (4 B): temperatura em décimos de °C, umidade/chuva em %.
+// Só as primeiras kMaxStations estações da StationTable têm histórico.
+class StationHistory
+{
+public:
+    static constexpr size_t kMaxStations = 16;
+
+    static constexpr int16_t kTempNone = INT16_MIN; // campo ausente no balde
+    static constexpr uint8_t kPctNone = 0xFF;
+
+    // Registra uma amostra da estação 'station' (índice da StationTable) no
+    // balde do instante da captura, 'captureS' em s de uptime local. Amostras
+    // que chegam atrasadas além do balde atual entram nele
+    static void add(int station, const TelemetrySample &s, uint32_t captureS);
+
+    // GET /api/history?range=15m|2h|24h[&station=<id>] (binário):
+    //   u8 versão (1), u8 nível, u16 n, u32 período_s, u32 agora_s,
+    //   u32 início_s do último balde; n pontos {i16 temp, u8 hum, u8 rain},
+    //   do mais antigo ao mais recente (little-endian, tempos em s de uptime).
+    // Sem 'station', usa a estação principal (a mesma de /api/dados).
+    static esp_err_t handler(httpd_req_t *req);
+};
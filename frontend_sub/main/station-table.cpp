@@ -0,0 +1,256 @@
+#include "station-table.h"
+#include "alerts.h"
+#include "metrics.h"
+#include "esp_timer.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+struct Station
+{
+    std::atomic<uint32_t> seq{0}; // ímpar = escrita em andamento
+    std::atomic<bool> used{false};
+    uint32_t hash = 0;
+    uint8_t topicLen = 0;
+    char topic[StationTable::kTopicLen];
+    float temp = 0.0f;
+    float hum = 0.0f;
+    float rain = 0.0f;
+    bool tempValid = false;
+    bool humValid = false;
+    bool rainValid = false;
+    const char *tempAlert = "normal"; // níveis de alerta da estação
+    const char *rainAlert = "sem_chuva";
+    uint32_t lastSeenMs = 0;
+    uint32_t messages = 0;
+    float intervalMs = 0.0f; // média móvel do intervalo entre mensagens
+};
+
+// Cópia consistente de uma entrada, feita pelo leitor
+struct StationView
+{
+    char topic[StationTable::kTopicLen];
+    uint8_t topicLen;
+    float temp, hum, rain;
+    bool tempValid, humValid, rainValid;
+    const char *tempAlert, *rainAlert;
+    uint32_t lastSeenMs;
+    uint32_t messages;
+    float intervalMs;
+};
+
+static Station stations[StationTable::kCapacity];
+static std::atomic<uint32_t> stationCount{0};
+static std::atomic<int> primarySlot{-1};
+
+static uint32_t fnv1a(const char *s, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t nowMs()
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Sondagem linear a partir do hash; devolve a entrada do tópico, uma vaga
+// nova (ainda não marcada como usada) ou nullptr com a tabela cheia
+static Station *findSlot(const char *topic, size_t len, uint32_t hash)
+{
+    size_t mask = StationTable::kCapacity - 1;
+    for (size_t i = 0; i < StationTable::kCapacity; ++i)
+    {
+        Station &st = stations[(hash + i) & mask];
+        if (!st.used.load(std::memory_order_relaxed))
+            return stationCount.load(std::memory_order_relaxed) < StationTable::kMaxStations ? &st : nullptr;
+        if (st.hash == hash && st.topicLen == len && memcmp(st.topic, topic, len) == 0)
+            return &st;
+    }
+    return nullptr;
+}
+
+int StationTable::slot(const char *topic, size_t topicLen)
+{
+    if (!topic || topicLen == 0)
+        return -1;
+    if (topicLen > kTopicLen)
+    {
+        Metrics::inc(Metric::StationsTopicTooLong);
+        return -1;
+    }
+    uint32_t hash = fnv1a(topic, topicLen);
+    Station *st = findSlot(topic, topicLen, hash);
+    if (!st)
+    {
+        Metrics::inc(Metric::StationsDropped);
+        return -1;
+    }
+    if (!st->used.load(std::memory_order_relaxed))
+    {
+        // Chave gravada antes de a entrada ficar visível aos leitores
+        st->hash = hash;
+        st->topicLen = (uint8_t)topicLen;
+        memcpy(st->topic, topic, topicLen);
+        st->messages = 0;
+        st->intervalMs = 0.0f;
+        st->used.store(true, std::memory_order_release);
+        stationCount.fetch_add(1, std::memory_order_relaxed);
+        if (primarySlot.load(std::memory_order_relaxed) < 0)
+            primarySlot.store((int)(st - stations), std::memory_order_relaxed);
+    }
+    return (int)(st - stations);
+}
+
+void StationTable::update(int station, const TelemetrySample &s)
+{
+    if (station < 0 || station >= (int)kCapacity)
+        return;
+    Station *st = &stations[station];
+    uint32_t now = nowMs();
+    uint32_t seq = st->seq.load(std::memory_order_relaxed);
+    st->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (st->messages > 0)
+    {
+        float dt = (float)(now - st->lastSeenMs);
+        st->intervalMs = st->intervalMs > 0.0f ? st->intervalMs * 0.8f + dt * 0.2f : dt;
+    }
+    if (s.tempValid)
+    {
+        st->temp = s.temp;
+        st->tempValid = true;
+    }
+    if (s.humValid)
+    {
+        st->hum = s.hum;
+        st->humValid = true;
+    }
+    if (s.rainValid)
+    {
+        st->rain = s.rain;
+        st->rainValid = true;
+    }
+    st->tempAlert = AlertManager::tempLabel(station);
+    st->rainAlert = AlertManager::rainLabel(station);
+    st->lastSeenMs = now;
+    st->messages++;
+
+    st->seq.store(seq + 2, std::memory_order_release);
+}
+
+size_t StationTable::count()
+{
+    return stationCount.load(std::memory_order_relaxed);
+}
+
+int StationTable::primary()
+{
+    return primarySlot.load(std::memory_order_relaxed);
+}
+
+static bool readStation(const Station &st, StationView &v)
+{
+    for (int attempt = 0; attempt < 8; ++attempt)
+    {
+        uint32_t s1 = st.seq.load(std::memory_order_acquire);
+        if (s1 & 1)
+            continue;
+        v.topicLen = st.topicLen;
+        memcpy(v.topic, st.topic, sizeof(v.topic));
+        v.temp = st.temp;
+        v.hum = st.hum;
+        v.rain = st.rain;
+        v.tempValid = st.tempValid;
+        v.humValid = st.humValid;
+        v.rainValid = st.rainValid;
+        v.tempAlert = st.tempAlert;
+        v.rainAlert = st.rainAlert;
+        v.lastSeenMs = st.lastSeenMs;
+        v.messages = st.messages;
+        v.intervalMs = st.intervalMs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (st.seq.load(std::memory_order_relaxed) == s1)
+            return true;
+    }
+    return false; // escrita contínua: a estação fica de fora desta resposta
+}
+
+// Tópico como string JSON (escapa aspas e barras; descarta controle)
+static size_t jsonTopic(char *out, size_t cap, const char *topic, size_t len)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < len && n + 2 < cap; ++i)
+    {
+        char c = topic[i];
+        if ((uint8_t)c < 0x20)
+            continue;
+        if (c == '"' || c == '\\')
+            out[n++] = '\\';
+        out[n++] = c;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static void fmtValue(char *out, size_t cap, bool valid, float v, const char *fmt)
+{
+    if (valid)
+        snprintf(out, cap, fmt, v);
+    else
+        snprintf(out, cap, "null");
+}
+
+esp_err_t StationTable::handler(httpd_req_t *req)
+{
+    Metrics::http(HttpEndpoint::Stations);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    uint32_t now = nowMs();
+    char item[384];
+    int n = snprintf(item, sizeof(item), "{\"now_ms\":%lu,\"count\":%u,\"capacity\":%u,\"primary\":%d,\"stations\":[",
+                     (unsigned long)now, (unsigned)count(), (unsigned)kMaxStations, primary());
+    esp_err_t ret = httpd_resp_send_chunk(req, item, (size_t)n);
+    bool first = true;
+
+    for (size_t i = 0; i < kCapacity && ret == ESP_OK; ++i)
+    {
+        const Station &st = stations[i];
+        StationView v;
+        if (!st.used.load(std::memory_order_acquire) || !readStation(st, v))
+            continue;
+
+        char topic[2 * kTopicLen + 1];
+        jsonTopic(topic, sizeof(topic), v.topic, v.topicLen);
+        char temp[16], hum[16], rain[16];
+        fmtValue(temp, sizeof(temp), v.tempValid, v.temp, "%.2f");
+        fmtValue(hum, sizeof(hum), v.humValid, v.hum, "%.2f");
+        fmtValue(rain, sizeof(rain), v.rainValid, v.rain, "%.1f");
+        float rate = v.intervalMs > 0.0f ? 60000.0f / v.intervalMs : 0.0f;
+
+        n = snprintf(item, sizeof(item),
+                     "%s{\"id\":%u,\"topic\":\"%s\",\"temp\":%s,\"hum\":%s,\"rain\":%s,"
+                     "\"alerts\":{\"temp\":\"%s\",\"rain\":\"%s\"},\"last_seen_ms\":%lu,\"age_ms\":%lu,"
+                     "\"messages\":%lu,\"rate_per_min\":%.2f}",
+                     first ? "" : ",", (unsigned)i, topic, temp, hum, rain, v.tempAlert, v.rainAlert,
+                     (unsigned long)v.lastSeenMs,
+                     (unsigned long)(now - v.lastSeenMs), (unsigned long)v.messages, rate);
+        if (n <= 0 || n >= (int)sizeof(item))
+            continue;
+        ret = httpd_resp_send_chunk(req, item, (size_t)n);
+        first = false;
+    }
+
+    if (ret == ESP_OK)
+        ret = httpd_resp_send_chunk(req, "]}", 2);
+    if (ret != ESP_OK)
+        return ret;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+#include "telemetry-codec.h"
+
+// Tabela de estações para assinaturas com curinga (ex.: esp/+/sensors).
+// Endereçamento aberto com sondagem linear, chave = tópico (hash FNV-1a),
+// capacidade fixa: atualização O(1) por mensagem e memória limitada.
+// Escritor único (task MQTT); cada entrada tem um seqlock próprio, então
+// o handler HTTP lê sem lock. Entradas não são removidas: com a tabela
+// cheia, estações novas são descartadas (contadas em /metrics).
+// A primeira estação registrada no boot é a principal: só ela alimenta a
+// leitura global (/api/dados, /ws, gráficos); as demais aparecem aqui.
+class StationTable
+{
+public:
+    static constexpr size_t kCapacity = 256;   // potência de 2
+    static constexpr size_t kMaxStations = 192; // fator de carga 0,75
+    static constexpr size_t kTopicLen = 64; // = tópico da config e MessageAssembler::kMaxTopic
+
+    // Localiza (ou cria) a estação do tópico. Retorna o índice da entrada
+    // (estável até o reboot, "id" em /api/stations) ou -1 com a tabela cheia
+    // ou tópico maior que kTopicLen (recusado, não truncado: dois tópicos
+    // com o mesmo prefixo virariam uma estação só)
+    static int slot(const char *topic, size_t topicLen);
+
+    // Aplica à estação os campos válidos da leitura mais recente da mensagem
+    static void update(int station, const TelemetrySample &s);
+
+    static size_t count();
+
+    // Índice da estação principal, ou -1 antes da primeira mensagem
+    static int primary();
+
+    // Handler de GET /api/stations: tabela inteira em uma resposta chunked
+    static esp_err_t handler(httpd_req_t *req);
+};
@@ -0,0 +1,416 @@
+#include "telemetry-codec.h"
+#include <string.h>
+
+static uint16_t getU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+    return (uint32_t)getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+static uint64_t getU64(const uint8_t *p)
+{
+    return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+}
+
+// Tamanho de cada amostra conforme a versão do cabeçalho (0 = desconhecida)
+static size_t sampleLen(uint8_t version)
+{
+    if (version == TelemetryCodec::kVersion)
+        return TelemetryCodec::kSampleLen;
+    if (version == TelemetryCodec::kVersionV1)
+        return TelemetryCodec::kSampleLenV1;
+    return 0;
+}
+
+int TelemetryCodec::binarySampleCount(const char *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    if (!p || len < kHeaderLen || p[0] != kMagic || sampleLen(p[1]) == 0)
+        return -1;
+    int n = p[2];
+    if (len < kHeaderLen + (size_t)n * sampleLen(p[1]))
+        return -1;
+    return n;
+}
+
+bool TelemetryCodec::isReplay(const char *data, size_t len)
+{
+    return binarySampleCount(data, len) >= 0 && (((const uint8_t *)data)[3] & kHdrReplay) != 0;
+}
+
+bool TelemetryCodec::decodeSample(const char *data, size_t len, int idx, TelemetrySample &out)
+{
+    int n = binarySampleCount(data, len);
+    if (idx < 0 || idx >= n)
+        return false;
+
+    size_t stride = sampleLen(((const uint8_t *)data)[1]);
+    const uint8_t *p = (const uint8_t *)data + kHeaderLen + (size_t)idx * stride;
+    int16_t t = (int16_t)getU16(p + 4);
+    uint16_t h = getU16(p + 6);
+
+    out.ts_ms = getU32(p);
+    out.tempValid = (t != INT16_MIN);
+    out.humValid = (h != 0xFFFF);
+    out.temp = out.tempValid ? t / 100.0f : 0.0f;
+    out.hum = out.humValid ? h / 100.0f : 0.0f;
+    out.rain = (float)p[8];
+    out.rainValid = true;
+    bool v2 = stride == kSampleLen;
+    out.seq = v2 ? getU32(p + 10) : 0;
+    out.boot = v2 ? getU16(p + 14) : 0;
+    out.epochMs = v2 ? getU64(p + 16) : 0;
+    return true;
+}
+
+// --- Parser JSON em fluxo ---
+
+static constexpr int kMaxDepth = 8; // aninhamento tolerado em campos desconhecidos
+
+struct JsonScanner
+{
+    const char *p;
+    const char *end;
+
+    void skipWs()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            ++p;
+    }
+
+    bool consume(char c)
+    {
+        skipWs();
+        if (p < end && *p == c)
+        {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    char peek()
+    {
+        skipWs();
+        return p < end ? *p : '\0';
+    }
+
+    // String na posição atual; devolve o conteúdo bruto (escapes não tratados)
+    bool string(const char *&str, size_t &len)
+    {
+        if (!consume('"'))
+            return false;
+        str = p;
+        while (p < end && *p != '"')
+        {
+            if (*p == '\\')
+                ++p;
+            ++p;
+        }
+        if (p >= end)
+            return false;
+        len = (size_t)(p - str);
+        ++p;
+        return true;
+    }
+
+    // Palavra sem aspas (true, false, null, nan, inf)
+    bool word(const char *&w, size_t &len)
+    {
+        w = p;
+        while (p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')))
+            ++p;
+        len = (size_t)(p - w);
+        return len > 0;
+    }
+
+    // Número JSON; 'nan'/'inf'/'null' (ou -nan) são aceitos como inválidos
+    bool number(float &out, bool &valid)
+    {
+        skipWs();
+        bool neg = false;
+        if (p < end && *p == '-')
+        {
+            neg = true;
+            ++p;
+        }
+        const char *w;
+        size_t wlen;
+        if (p < end && !(*p >= '0' && *p <= '9'))
+        {
+            valid = false;
+            return word(w, wlen);
+        }
+
+        double mant = 0;
+        int exp10 = 0;
+        bool digits = false;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            mant = mant * 10 + (*p++ - '0');
+            digits = true;
+        }
+        if (p < end && *p == '.')
+        {
+            ++p;
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                mant = mant * 10 + (*p++ - '0');
+                --exp10;
+                digits = true;
+            }
+        }
+        if (!digits)
+            return false;
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            ++p;
+            bool eneg = false;
+            if (p < end && (*p == '+' || *p == '-'))
+                eneg = (*p++ == '-');
+            int e = 0;
+            if (p >= end || !(*p >= '0' && *p <= '9'))
+                return false;
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                if (e < 1000)
+                    e = e * 10 + (*p - '0');
+                ++p;
+            }
+            exp10 += eneg ? -e : e;
+        }
+        for (; exp10 > 0; --exp10)
+            mant *= 10;
+        for (; exp10 < 0; ++exp10)
+            mant /= 10;
+        out = (float)(neg ? -mant : mant);
+        valid = true;
+        return true;
+    }
+
+    // Inteiro sem sinal exato (seq e epoch_ms não cabem em float).
+    // Negativos, frações e palavras (null) ficam inválidos
+    bool integer(uint64_t &out, bool &valid)
+    {
+        skipWs();
+        const char *start = p;
+        uint64_t v = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+            v = v * 10 + (uint64_t)(*p++ - '0');
+        if (p > start && (p >= end || (*p != '.' && *p != 'e' && *p != 'E')))
+        {
+            out = v;
+            valid = true;
+            return true;
+        }
+        p = start;
+        float f;
+        if (!number(f, valid))
+            return false;
+        valid = false;
+        return true;
+    }
+
+    bool skipValue(int depth)
+    {
+        if (depth > kMaxDepth)
+            return false;
+        const char *s;
+        size_t n;
+        float f;
+        bool v;
+        switch (peek())
+        {
+        case '"':
+            return string(s, n);
+        case '{':
+            ++p;
+            if (consume('}'))
+                return true;
+            do
+            {
+                if (!string(s, n) || !consume(':') || !skipValue(depth + 1))
+                    return false;
+            } while (consume(','));
+            return consume('}');
+        case '[':
+            ++p;
+            if (consume(']'))
+                return true;
+            do
+            {
+                if (!skipValue(depth + 1))
+                    return false;
+            } while (consume(','));
+            return consume(']');
+        case '\0':
+            return false;
+        default:
+            return number(f, v);
+        }
+    }
+};
+
+static bool keyIs(const char *key, size_t len, const char *name)
+{
+    return len == strlen(name) && memcmp(key, name, len) == 0;
+}
+
+// Campo de amostra; false só em erro de sintaxe. 'known' indica se a chave
+// pertence à amostra (senão o chamador trata/pula o valor).
+static bool sampleField(JsonScanner &js, const char *key, size_t len, TelemetrySample &s, bool &known)
+{
+    float v = 0;
+    bool valid = false;
+    known = true;
+    if (keyIs(key, len, "dht_temp"))
+    {
+        if (!js.number(v, valid))
+            return false;
+        s.temp = valid ? v : 0.0f;
+        s.tempValid = valid;
+    }
+    else if (keyIs(key, len, "dht_hum"))
+    {
+        if (!js.number(v, valid))
+            return false;
+        s.hum = valid ? v : 0.0f;
+        s.humValid = valid;
+    }
+    else if (keyIs(key, len, "rain_pct"))
+    {
+        if (!js.number(v, valid))
+            return false;
+        s.rain = valid ? v : 0.0f;
+        s.rainValid = valid;
+    }
+    else if (keyIs(key, len, "ts_ms") || keyIs(key, len, "seq") || keyIs(key, len, "boot") ||
+             keyIs(key, len, "epoch_ms"))
+    {
+        uint64_t n = 0;
+        if (!js.integer(n, valid))
+            return false;
+        if (!valid)
+            n = 0;
+        if (key[0] == 't')
+            s.ts_ms = (uint32_t)n;
+        else if (key[0] == 's')
+            s.seq = (uint32_t)n;
+        else if (key[0] == 'b')
+            s.boot = (uint16_t)n;
+        else
+            s.epochMs = n;
+    }
+    else
+    {
+        known = false;
+    }
+    return true;
+}
+
+static bool sampleObject(JsonScanner &js, TelemetrySample &s)
+{
+    if (!js.consume('{'))
+        return false;
+    if (js.consume('}'))
+        return true;
+    do
+    {
+        const char *key;
+        size_t len;
+        bool known;
+        if (!js.string(key, len) || !js.consume(':') || !sampleField(js, key, len, s, known))
+            return false;
+        if (!known && !js.skipValue(1))
+            return false;
+    } while (js.consume(','));
+    return js.consume('}');
+}
+
+bool TelemetryCodec::parseJson(const char *data, size_t len, TelemetryBatch &out)
+{
+    out.count = 0;
+    out.replay = false;
+    JsonScanner js{data, data + len};
+
+    TelemetrySample single;
+    bool hasSingle = false;
+    bool hasArray = false;
+
+    if (!data || !js.consume('{'))
+        return false;
+    if (!js.consume('}'))
+    {
+        do
+        {
+            const char *key;
+            size_t klen;
+            bool known;
+            if (!js.string(key, klen) || !js.consume(':'))
+                return false;
+
+            if (keyIs(key, klen, "samples") && js.peek() == '[')
+            {
+                hasArray = true;
+                js.consume('[');
+                if (!js.consume(']'))
+                {
+                    do
+                    {
+                        if (js.peek() == '{' && out.count < TelemetryBatch::kMaxSamples)
+                        {
+                            out.samples[out.count] = TelemetrySample();
+                            if (!sampleObject(js, out.samples[out.count]))
+                                return false;
+                            out.count++;
+                        }
+                        else if (!js.skipValue(1))
+                        {
+                            return false;
+                        }
+                    } while (js.consume(','));
+                    if (!js.consume(']'))
+                        return false;
+                }
+            }
+            else if (keyIs(key, klen, "replay"))
+            {
+                const char *w;
+                size_t wlen;
+                js.skipWs();
+                if (!js.word(w, wlen))
+                    return false;
+                out.replay = keyIs(w, wlen, "true");
+            }
+            else
+            {
+                if (!sampleField(js, key, klen, single, known))
+                    return false;
+                if (known)
+                    hasSingle = true;
+                else if (!js.skipValue(1))
+                    return false;
+            }
+        } while (js.consume(','));
+        if (!js.consume('}'))
+            return false;
+    }
+
+    // Aceita apenas espaços (ou '\0' de quem publicou com terminador) no fim
+    js.skipWs();
+    while (js.p < js.end && *js.p == '\0')
+        ++js.p;
+    if (js.p != js.end)
+        return false;
+
+    if (!hasArray && hasSingle)
+    {
+        out.samples[0] = single;
+        out.count = 1;
+    }
+    return true;
+}
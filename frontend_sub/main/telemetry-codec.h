@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Formato binário publicado pelo backend_pub (ver payload.h de lá):
+//   cabeçalho: [0]=magic [1]=versão [2]=n amostras [3]=flags do lote
+//   amostra v1 (10 B): u32 ts_ms | i16 temp_c*100 | u16 hum*100 | u8 rain_pct | u8 flags
+//   amostra v2 (24 B): v1 + u32 seq | u16 boot | u64 epoch_ms
+//
+// Formato JSON (payload.cpp de lá), amostra única ou lote:
+//   {"seq":7,"boot":3,"ts_ms":1234,"epoch_ms":...,"dht_temp":25.10,"dht_hum":60.00,"rain_pct":3}
+//   {"replay":true,"samples":[{"seq":5,...},...]}
+struct TelemetrySample
+{
+    uint32_t ts_ms = 0;
+    uint32_t seq = 0;     // sequência por boot do publicador (0 = ausente)
+    uint16_t boot = 0;
+    uint64_t epochMs = 0; // captura em epoch (0 = publicador sem SNTP)
+    float temp = 0.0f;
+    float hum = 0.0f;
+    float rain = 0.0f;
+    bool tempValid = false;
+    bool humValid = false;
+    bool rainValid = false;
+};
+
+// Resultado do parser JSON: tamanho fixo, sem heap
+struct TelemetryBatch
+{
+    static constexpr int kMaxSamples = 16; // PAYLOAD_BATCH_MAX no publicador
+    TelemetrySample samples[kMaxSamples];
+    int count = 0;
+    bool replay = false;
+};
+
+class TelemetryCodec
+{
+public:
+    static constexpr uint8_t kMagic = 0xB7;
+    static constexpr uint8_t kVersionV1 = 1;
+    static constexpr uint8_t kVersion = 2;
+    static constexpr size_t kHeaderLen = 4;
+    static constexpr size_t kSampleLenV1 = 10;
+    static constexpr size_t kSampleLen = 24;
+    static constexpr uint8_t kHdrReplay = 0x01; // lote reenviado da fila em flash
+
+    // Verifica magic, versão e tamanho; devolve o número de amostras ou -1
+    static int binarySampleCount(const char *data, size_t len);
+
+    // Lote de amostras antigas reenviadas após reconexão do publicador
+    static bool isReplay(const char *data, size_t len);
+
+    // Decodifica a amostra 'idx' direto do payload, sem alocação
+    static bool decodeSample(const char *data, size_t len, int idx, TelemetrySample &out);
+
+    // Parser JSON em fluxo, específico do esquema acima: lê apenas os campos
+    // de telemetria e pula o resto, sem alocar nem exigir '\0' no fim.
+    // Valores não numéricos (null, nan) deixam o campo inválido. Amostras
+    // além de kMaxSamples são ignoradas. false se o JSON estiver malformado.
+    static bool parseJson(const char *data, size_t len, TelemetryBatch &out);
+};
@@ -0,0 +1,40 @@
+#include "time-sync.h"
+#include "esp_log.h"
+#include "esp_sntp.h"
+#include <sys/time.h>
+#include <atomic>
+
+static const char *TAG = "TIME_SYNC";
+static const char *kServer = "pool.ntp.org";
+
+static std::atomic<bool> isSynced{false};
+
+static void onSync(struct timeval *tv)
+{
+    if (!isSynced.exchange(true, std::memory_order_relaxed))
+        ESP_LOGI(TAG, "Relogio sincronizado via SNTP");
+}
+
+void TimeSync::start()
+{
+    if (esp_sntp_enabled())
+        return;
+    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    esp_sntp_setservername(0, kServer);
+    sntp_set_time_sync_notification_cb(onSync);
+    esp_sntp_init();
+}
+
+bool TimeSync::synced()
+{
+    return isSynced.load(std::memory_order_relaxed);
+}
+
+uint64_t TimeSync::nowEpochMs()
+{
+    if (!synced())
+        return 0;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000 + (uint64_t)tv.tv_usec / 1000;
+}
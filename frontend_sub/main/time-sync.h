@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+
+// Relógio de parede via SNTP, usado para medir a latência da telemetria
+// (epoch_ms da captura no publicador contra a hora de recebimento aqui)
+class TimeSync
+{
+public:
+    // Inicia o SNTP em modo poll; sem rede, o lwIP segue tentando
+    static void start();
+
+    static bool synced();
+
+    // Hora atual em epoch (ms); 0 enquanto não sincronizado
+    static uint64_t nowEpochMs();
+};
@@ -0,0 +1,167 @@
+#include "web-assets.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <string.h>
+
+static const char *TAG = "WEB_ASSETS";
+
+// Formato da imagem: ver tools/embed_web_assets.py
+static constexpr char IMAGE_MAGIC[4] = {'W', 'A', 'I', '1'};
+static constexpr uint16_t IMAGE_VERSION = 1;
+static constexpr uint32_t IMAGE_FLAG_IMMUTABLE = 0x01;
+
+struct __attribute__((packed)) ImageHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t count;
+    uint32_t totalLen;
+    uint32_t reserved;
+};
+
+struct __attribute__((packed)) ImageEntry
+{
+    uint32_t pathOff;
+    uint32_t mimeOff;
+    uint32_t etagOff;
+    uint32_t dataOff;
+    uint32_t dataLen;
+    uint32_t flags;
+    uint32_t reserved[2];
+};
+
+static const uint8_t *image = nullptr; // imagem mapeada (nullptr = usa a tabela embutida)
+static const ImageEntry *entries = nullptr;
+static uint16_t entryCount = 0;
+static esp_partition_mmap_handle_t mmapHandle;
+
+// Compara 'path' (não terminado em '\0') com uma string C
+static int pathCompare(const char *path, size_t len, const char *s)
+{
+    int c = strncmp(path, s, len);
+    if (c != 0)
+        return c;
+    return s[len] == '\0' ? 0 : -1;
+}
+
+// String terminada em '\0' dentro dos limites da imagem
+static bool stringOk(uint32_t off, uint32_t total)
+{
+    return off < total && memchr(image + off, '\0', total - off) != nullptr;
+}
+
+// Valida o índice uma única vez no boot; depois as buscas confiam nos offsets
+static bool imageValid(uint32_t total)
+{
+    const char *prev = nullptr;
+    for (uint16_t i = 0; i < entryCount; ++i)
+    {
+        const ImageEntry &e = entries[i];
+        if (!stringOk(e.pathOff, total) || !stringOk(e.mimeOff, total) || !stringOk(e.etagOff, total))
+            return false;
+        if (e.dataOff > total || e.dataLen > total - e.dataOff)
+            return false;
+        const char *path = (const char *)image + e.pathOff;
+        if (prev && strcmp(prev, path) >= 0) // precisa estar ordenada
+            return false;
+        prev = path;
+    }
+    return true;
+}
+
+void WebAssets::init()
+{
+    const esp_partition_t *part =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    if (!part)
+    {
+        ESP_LOGW(TAG, "Partição 'storage' não encontrada; usando assets embutidos");
+        return;
+    }
+
+    ImageHeader hdr;
+    if (esp_partition_read(part, 0, &hdr, sizeof(hdr)) != ESP_OK || memcmp(hdr.magic, IMAGE_MAGIC, 4) != 0 ||
+        hdr.version != IMAGE_VERSION || hdr.totalLen > part->size ||
+        hdr.totalLen < sizeof(hdr) + (uint32_t)hdr.count * sizeof(ImageEntry))
+    {
+        ESP_LOGW(TAG, "Imagem de assets ausente ou inválida; usando assets embutidos");
+        return;
+    }
+
+    const void *ptr = nullptr;
+    esp_err_t err = esp_partition_mmap(part, 0, hdr.totalLen, ESP_PARTITION_MMAP_DATA, &ptr, &mmapHandle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Falha ao mapear a partição (%s)", esp_err_to_name(err));
+        return;
+    }
+    image = (const uint8_t *)ptr;
+    entries = (const ImageEntry *)(image + sizeof(ImageHeader));
+    entryCount = hdr.count;
+
+    if (!imageValid(hdr.totalLen))
+    {
+        ESP_LOGE(TAG, "Índice da imagem de assets corrompido; usando assets embutidos");
+        esp_partition_munmap(mmapHandle);
+        image = nullptr;
+        entries = nullptr;
+        entryCount = 0;
+        return;
+    }
+    ESP_LOGI(TAG, "Imagem de assets mapeada: %u arquivos, %u bytes", (unsigned)entryCount, (unsigned)hdr.totalLen);
+}
+
+bool WebAssets::findImage(const char *path, size_t len, WebAsset &out)
+{
+    size_t lo = 0;
+    size_t hi = entryCount;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        const ImageEntry &e = entries[mid];
+        int c = pathCompare(path, len, (const char *)image + e.pathOff);
+        if (c == 0)
+        {
+            out.path = (const char *)image + e.pathOff;
+            out.mime = (const char *)image + e.mimeOff;
+            out.gz = image + e.dataOff;
+            out.gzLen = e.dataLen;
+            out.etag = (const char *)image + e.etagOff;
+            out.immutable = (e.flags & IMAGE_FLAG_IMMUTABLE) != 0;
+            return true;
+        }
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return false;
+}
+
+bool WebAssets::findEmbedded(const char *path, size_t len, WebAsset &out)
+{
+    size_t lo = 0;
+    size_t hi = g_web_assets_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = pathCompare(path, len, g_web_assets[mid].path);
+        if (c == 0)
+        {
+            out = g_web_assets[mid];
+            return true;
+        }
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return false;
+}
+
+bool WebAssets::find(const char *path, size_t len, WebAsset &out)
+{
+    if (image)
+        return findImage(path, len, out);
+    return findEmbedded(path, len, out);
+}
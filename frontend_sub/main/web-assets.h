@@ -0,0 +1,35 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Arquivos de web/ comprimidos (gzip) em tempo de build
+// (tools/embed_web_assets.py). A fonte principal é a imagem gravada na
+// partição 'storage' e mapeada em memória no boot; a tabela embutida no
+// firmware é usada quando a partição não tem uma imagem válida. As duas
+// são ordenadas por caminho.
+struct WebAsset
+{
+    const char *path;  // ex.: "/index.html"
+    const char *mime;
+    const uint8_t *gz; // conteúdo gzip
+    uint32_t gzLen;
+    const char *etag;  // ETag forte (hash do conteúdo), já com aspas
+    bool immutable;    // referenciado com ?v=<hash>: pode ficar em cache
+};
+
+extern const WebAsset g_web_assets[];
+extern const size_t g_web_assets_count;
+
+class WebAssets
+{
+public:
+    // Mapeia a imagem da partição 'storage' (sem sistema de arquivos)
+    static void init();
+    // Busca binária pelo caminho (len bytes de 'path', sem query string).
+    // Os ponteiros de 'out' apontam para a flash e valem até o reboot.
+    static bool find(const char *path, size_t len, WebAsset &out);
+
+private:
+    static bool findImage(const char *path, size_t len, WebAsset &out);
+    static bool findEmbedded(const char *path, size_t len, WebAsset &out);
+};
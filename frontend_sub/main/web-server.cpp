@@ -3,59 +3,116 @@
 #include "wifi.h"
 #include "cJSON.h"
 #include "esp_log.h"
-#include "SensorData.h"
-#include "alerts.h"
-#include <string>
+#include "sensor-snapshot.h"
+#include "metrics.h"
+#include "long-poll.h"
+#include "station-table.h"
+#include "station-history.h"
+#include "link-stats.h"
 
 static const char *TAG = "WEB_SERVER";
 
-void WebServer::mountSpiffs()
+#define WS_MAX_CLIENTS 8 // limitado por max_open_sockets
+
+httpd_handle_t WebServer::liveServer = nullptr;
+
+// Frame serializado uma vez e enviado a todos os clientes (fd = -1)
+// ou apenas ao que acabou de conectar
+struct WsFrame
 {
-    esp_vfs_spiffs_conf_t conf = {
-        .base_path = "/spiffs",
-        .partition_label = "storage",
-        .max_files = 5,
-        .format_if_mount_failed = true};
-    if (esp_vfs_spiffs_register(&conf) != ESP_OK)
+    int fd;
+    size_t len;
+    char data[];
+};
+
+// Copia o snapshot pré-serializado (sem cJSON nem heap). 'notModified'
+// responde 304 com o ETag atual (cliente já tem a versão / long-poll expirou).
+esp_err_t WebServer::sendSnapshot(httpd_req_t *req, bool notModified)
+{
+    char json[SensorSnapshot::kMaxLen];
+    uint32_t version = 0;
+    size_t len = SensorSnapshot::read(json, sizeof(json), version);
+
+    char etag[16];
+    SensorSnapshot::etag(version, etag, sizeof(etag));
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (notModified)
     {
-        ESP_LOGE(TAG, "Falha ao montar SPIFFS");
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, len);
 }
 
+// /api/dados: resposta imediata, 304 via If-None-Match, ou long-poll com
+// ?after=<versão> (segura a requisição até chegar outra versão)
 esp_err_t WebServer::apiDataHandler(httpd_req_t *req)
 {
+    Metrics::http(HttpEndpoint::Data);
+    uint32_t current = SensorSnapshot::version();
 
-    float temp = globalSensorData.temp;
-    float hum = globalSensorData.hum;
-    float rain = globalSensorData.rain;
-    Alerts alerts = AlertManager::evaluate(temp, rain);
-
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "temp", temp);
-    cJSON_AddNumberToObject(root, "hum", hum);
-    cJSON_AddNumberToObject(root, "rain", rain);
-    cJSON *alertsObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(alertsObj, "temp", AlertManager::tempLabel(alerts.temp));
-    cJSON_AddStringToObject(alertsObj, "rain", AlertManager::rainLabel(alerts.rain));
-    cJSON_AddItemToObject(root, "alerts", alertsObj);
+    char query[24];
+    char val[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "after", val, sizeof(val)) == ESP_OK)
+    {
+        uint32_t after = (uint32_t)strtoul(val, NULL, 10);
+        if (after != current)
+            return sendSnapshot(req, false);
+        if (LongPoll::park(req, after))
+            return ESP_OK;
+        // Sem vaga: cliente tenta de novo em instantes
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "2");
+        return httpd_resp_send(req, NULL, 0);
+    }
 
-    const char *json_str = cJSON_PrintUnformatted(root);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_str, strlen(json_str));
+    char etag[16];
+    char inm[16];
+    SensorSnapshot::etag(current, etag, sizeof(etag));
+    bool match = current != 0 && httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK &&
+                 strcmp(inm, etag) == 0;
+    return sendSnapshot(req, match);
+}
 
-    free((void *)json_str);
-    cJSON_Delete(root);
-    return ESP_OK;
+// Campo numérico do formulário (string ou número); mantém 'out' se ausente
+static void readFloat(cJSON *root, const char *key, float &out)
+{
+    cJSON *item = cJSON_GetObjectItem(root, key);
+    if (cJSON_IsString(item) && item->valuestring[0])
+        out = (float)atof(item->valuestring);
+    else if (cJSON_IsNumber(item))
+        out = (float)item->valuedouble;
 }
 
 // --- PROCESSA O FORMULÁRIO DE CONFIG DO FRONTEND ---
 esp_err_t WebServer::apiConfigHandler(httpd_req_t *req)
 {
+    Metrics::http(HttpEndpoint::Config);
     char buf[512]; // Aumentado para caber todos os campos
-    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
-    if (ret <= 0)
+    size_t total = req->content_len;
+    if (total >= sizeof(buf))
+    {
+        httpd_resp_set_status(req, "413 Payload Too Large");
+        httpd_resp_send(req, NULL, 0);
         return ESP_FAIL;
-    buf[ret] = '\0';
+    }
+    // O corpo pode chegar em vários segmentos TCP: lê até content_len,
+    // para nunca interpretar um JSON parcial
+    size_t received = 0;
+    int timeouts = 0;
+    while (received < total)
+    {
+        int ret = httpd_req_recv(req, buf + received, total - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts <= 3)
+            continue;
+        if (ret <= 0)
+            return ESP_FAIL;
+        received += (size_t)ret;
+    }
+    buf[received] = '\0';
 
     cJSON *root = cJSON_Parse(buf);
     if (!root)
@@ -103,6 +160,12 @@ esp_err_t WebServer::apiConfigHandler(httpd_req_t *req)
     else if (cJSON_IsNumber(item))
         newConfig.mqtt_qos = item->valueint;
 
+    // Limiares de alerta (ausentes = padrão)
+    readFloat(root, "alert_temp_mid", newConfig.alert_temp_mid);
+    readFloat(root, "alert_temp_high", newConfig.alert_temp_high);
+    readFloat(root, "alert_rain_mid", newConfig.alert_rain_mid);
+    readFloat(root, "alert_rain_heavy", newConfig.alert_rain_heavy);
+
     ConfigManager::save(newConfig);
 
     char ip_buf[32] = {0};
@@ -131,6 +194,7 @@ esp_err_t WebServer::apiConfigHandler(httpd_req_t *req)
 // --- RETORNA CONFIGURACAO SALVA ---
 esp_err_t WebServer::apiGetConfigHandler(httpd_req_t *req)
 {
+    Metrics::http(HttpEndpoint::Config);
     AppConfig cfg;
     ConfigManager::load(cfg);
 
@@ -143,6 +207,10 @@ esp_err_t WebServer::apiGetConfigHandler(httpd_req_t *req)
     cJSON_AddNumberToObject(root, "qos", cfg.mqtt_qos);
     cJSON_AddStringToObject(root, "user", cfg.mqtt_user);
     cJSON_AddStringToObject(root, "pass_mqtt", cfg.mqtt_pass);
+    cJSON_AddNumberToObject(root, "alert_temp_mid", cfg.alert_temp_mid);
+    cJSON_AddNumberToObject(root, "alert_temp_high", cfg.alert_temp_high);
+    cJSON_AddNumberToObject(root, "alert_rain_mid", cfg.alert_rain_mid);
+    cJSON_AddNumberToObject(root, "alert_rain_heavy", cfg.alert_rain_heavy);
 
     const char *json_str = cJSON_PrintUnformatted(root);
     httpd_resp_set_type(req, "application/json");
@@ -155,6 +223,7 @@ esp_err_t WebServer::apiGetConfigHandler(httpd_req_t *req)
 // --- LIMPA CONFIGURACAO NA NVS ---
 esp_err_t WebServer::apiConfigClearHandler(httpd_req_t *req)
 {
+    Metrics::http(HttpEndpoint::Config);
     ConfigManager::clear();
     cJSON *resp = cJSON_CreateObject();
     cJSON_AddStringToObject(resp, "message", "Memoria limpa");
@@ -171,38 +240,123 @@ esp_err_t WebServer::apiConfigClearHandler(httpd_req_t *req)
     return ESP_OK;
 }
 
-esp_err_t WebServer::fileHandler(httpd_req_t *req)
+// Asset: gzip + ETag forte; 304 quando o cliente já tem a versão.
+// CSS/JS são referenciados com ?v=<hash> e podem ficar em cache indefinidamente.
+esp_err_t WebServer::sendAsset(httpd_req_t *req, const WebAsset *asset)
 {
-    std::string path = "/spiffs";
-    if (strcmp(req->uri, "/") == 0)
-        path += "/index.html";
-    else
-        path += req->uri;
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", asset->immutable ? "public, max-age=31536000, immutable" : "no-cache");
 
-    FILE *fd = fopen(path.c_str(), "r");
-    if (!fd)
+    char inm[48];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK && strstr(inm, asset->etag))
+    {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_type(req, asset->mime);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)asset->gz, asset->gzLen);
+}
+
+esp_err_t WebServer::fileHandler(httpd_req_t *req)
+{
+    Metrics::http(HttpEndpoint::Static);
+    // Busca no índice de assets e envia direto da flash mapeada, sem abrir arquivo
+    size_t uriLen = strcspn(req->uri, "?");
+    WebAsset asset;
+    bool found = (uriLen == 1 && req->uri[0] == '/') ? WebAssets::find("/index.html", 11, asset)
+                                                    : WebAssets::find(req->uri, uriLen, asset);
+    if (!found)
     {
         httpd_resp_send_404(req);
         return ESP_FAIL;
     }
+    return sendAsset(req, &asset);
+}
 
-    // MIME Types básicos
-    if (path.find(".css") != std::string::npos)
-        httpd_resp_set_type(req, "text/css");
-    else if (path.find(".js") != std::string::npos)
-        httpd_resp_set_type(req, "application/javascript");
-    else
-        httpd_resp_set_type(req, "text/html");
+// --- FEED AO VIVO (WebSocket em /ws) ---
+esp_err_t WebServer::wsHandler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET)
+    {
+        Metrics::http(HttpEndpoint::Ws); // só o handshake; frames não contam
+        // Handshake concluído: envia a leitura atual para não esperar a próxima amostra
+        ESP_LOGI(TAG, "Dashboard conectado ao feed ao vivo");
+        queueSample(httpd_req_to_sockfd(req));
+        return ESP_OK;
+    }
+
+    // Mensagens do cliente são ignoradas (apenas drena o frame)
+    httpd_ws_frame_t frame = {};
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK || frame.len == 0)
+        return ret;
+    if (frame.len > 128)
+        return ESP_FAIL;
+    uint8_t buf[128];
+    frame.payload = buf;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
 
-    char chunk[1024];
-    size_t chunksize;
-    while ((chunksize = fread(chunk, 1, sizeof(chunk), fd)) > 0)
+// Executa na task do httpd: envia o frame e o libera
+void WebServer::wsSendWork(void *arg)
+{
+    WsFrame *f = (WsFrame *)arg;
+    httpd_ws_frame_t ws = {};
+    ws.final = true;
+    ws.type = HTTPD_WS_TYPE_TEXT;
+    ws.payload = (uint8_t *)f->data;
+    ws.len = f->len;
+
+    if (f->fd >= 0)
     {
-        httpd_resp_send_chunk(req, chunk, chunksize);
+        httpd_ws_send_frame_async(liveServer, f->fd, &ws);
     }
-    httpd_resp_send_chunk(req, NULL, 0);
-    fclose(fd);
-    return ESP_OK;
+    else
+    {
+        size_t n = WS_MAX_CLIENTS;
+        int fds[WS_MAX_CLIENTS];
+        if (httpd_get_client_list(liveServer, &n, fds) == ESP_OK)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (httpd_ws_get_fd_info(liveServer, fds[i]) == HTTPD_WS_CLIENT_WEBSOCKET)
+                    httpd_ws_send_frame_async(liveServer, fds[i], &ws);
+            }
+        }
+    }
+    free(f);
+}
+
+void WebServer::queueSample(int fd)
+{
+    if (!liveServer)
+        return;
+
+    // Mesmo JSON servido por /api/dados, já serializado pela task MQTT
+    char json[SensorSnapshot::kMaxLen];
+    uint32_t version = 0;
+    size_t n = SensorSnapshot::read(json, sizeof(json), version);
+    if (n == 0)
+        return;
+
+    WsFrame *f = (WsFrame *)malloc(sizeof(WsFrame) + n);
+    if (!f)
+        return;
+    f->fd = fd;
+    f->len = n;
+    memcpy(f->data, json, n);
+    // Envio acontece na task do httpd; se a fila estiver cheia o frame é descartado
+    if (httpd_queue_work(liveServer, wsSendWork, f) != ESP_OK)
+        free(f);
+    else if (fd < 0)
+        Metrics::inc(Metric::WsBroadcasts);
+}
+
+void WebServer::broadcastSample()
+{
+    queueSample(-1);
 }
 
 void WebServer::start()
@@ -210,9 +364,11 @@ void WebServer::start()
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.uri_match_fn = httpd_uri_match_wildcard;
     config.stack_size = 8192; // Aumentado para segurança
+    config.max_uri_handlers = 12;
 
     if (httpd_start(&server, &config) == ESP_OK)
     {
+        LongPoll::start();
         httpd_uri_t api_data = {"/api/dados", HTTP_GET, apiDataHandler, NULL};
         httpd_register_uri_handler(server, &api_data);
 
@@ -225,6 +381,22 @@ void WebServer::start()
         httpd_uri_t api_config_clear = {"/api/config/clear", HTTP_POST, apiConfigClearHandler, NULL};
         httpd_register_uri_handler(server, &api_config_clear);
 
+        httpd_uri_t ws = {"/ws", HTTP_GET, wsHandler, NULL, true};
+        httpd_register_uri_handler(server, &ws);
+        liveServer = server;
+
+        httpd_uri_t metrics = {"/metrics", HTTP_GET, Metrics::handler, NULL};
+        httpd_register_uri_handler(server, &metrics);
+
+        httpd_uri_t stations = {"/api/stations", HTTP_GET, StationTable::handler, NULL};
+        httpd_register_uri_handler(server, &stations);
+
+        httpd_uri_t history = {"/api/history", HTTP_GET, StationHistory::handler, NULL};
+        httpd_register_uri_handler(server, &history);
+
+        httpd_uri_t link = {"/api/link", HTTP_GET, LinkStats::handler, NULL};
+        httpd_register_uri_handler(server, &link);
+
         httpd_uri_t file_serve = {"/*", HTTP_GET, fileHandler, NULL};
         httpd_register_uri_handler(server, &file_serve);
 
@@ -1,20 +1,28 @@
 #pragma once
 #include "esp_http_server.h"
 #include "app.config.h"
-#include "esp_spiffs.h"
+#include "web-assets.h"
 
 class WebServer
 {
 private:
     httpd_handle_t server = nullptr;
+    static httpd_handle_t liveServer; // usado pelo broadcast do feed ao vivo
 
     static esp_err_t apiDataHandler(httpd_req_t *req);
     static esp_err_t apiConfigHandler(httpd_req_t *req);
     static esp_err_t apiGetConfigHandler(httpd_req_t *req);
     static esp_err_t apiConfigClearHandler(httpd_req_t *req);
     static esp_err_t fileHandler(httpd_req_t *req);
+    static esp_err_t sendAsset(httpd_req_t *req, const WebAsset *asset);
+    static esp_err_t wsHandler(httpd_req_t *req);
+    static void wsSendWork(void *arg);
+    static void queueSample(int fd);
 
 public:
     void start();
-    static void mountSpiffs();
+    // Envia a leitura atual a todos os dashboards conectados em /ws
+    static void broadcastSample();
+    // Responde com o snapshot de /api/dados (ou 304 com o ETag atual)
+    static esp_err_t sendSnapshot(httpd_req_t *req, bool notModified);
 };
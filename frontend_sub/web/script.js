@@ -3,7 +3,10 @@ let updateInterval = 2000;
 let isPaused = false;
 let intervalId = null;
 let charts = {}; // Armazena instâncias dos gráficos
+let liveSocket = null; // feed ao vivo (/ws); polling só como fallback
+let dataEtag = null; // versão da última leitura recebida (ETag de /api/dados)
 const MAX_DATA_POINTS = 30; // Mantém o gráfico leve
+let chartMaxPoints = MAX_DATA_POINTS; // cresce quando o histórico é carregado
 
 // Estado para cálculo de Delta (Variação)
 let lastValues = { temp: 0, hum: 0, rain: 0 };
@@ -11,12 +14,84 @@ let lastValues = { temp: 0, hum: 0, rain: 0 };
 // --- Inicialização ---
 document.addEventListener('DOMContentLoaded', () => {
     initCharts();
+    loadHistory();
     startDataLoop();
     // Tenta uma leitura imediata ao carregar
     fetchData();
     loadConfig();
+    connectLiveFeed();
 });
 
+// --- Feed ao vivo via WebSocket ---
+// O ESP32 envia cada amostra assim que chega do MQTT. Enquanto o socket
+// estiver aberto o polling fica suspenso; ao cair, volta o polling e
+// uma nova conexão é tentada.
+function connectLiveFeed() {
+    if (!window.WebSocket) {
+        longPoll();
+        return;
+    }
+    liveSocket = new WebSocket(`ws://${location.host}/ws`);
+
+    liveSocket.onopen = () => {
+        if (intervalId) clearInterval(intervalId);
+        intervalId = null;
+        setConnectionStatus(true);
+    };
+
+    liveSocket.onmessage = (ev) => {
+        if (isPaused) return;
+        try {
+            const data = JSON.parse(ev.data);
+            if (typeof data.version === 'number') dataEtag = `"v${data.version}"`;
+            updateDashboard(data);
+            setConnectionStatus(true);
+        } catch (e) {
+            console.warn('Frame invalido no feed ao vivo', e);
+        }
+    };
+
+    liveSocket.onclose = () => {
+        liveSocket = null;
+        if (!intervalId) startDataLoop();
+        setTimeout(connectLiveFeed, 3000);
+    };
+}
+
+// --- Long-poll (navegadores sem WebSocket) ---
+// O ESP32 segura a requisição até chegar uma amostra diferente da versão
+// informada; 304 significa que o prazo expirou sem novidades.
+let longPollActive = false;
+async function longPoll() {
+    if (longPollActive) return;
+    longPollActive = true;
+    if (intervalId) clearInterval(intervalId);
+    intervalId = null;
+
+    let version = 0;
+    while (true) {
+        try {
+            const resp = await fetch(`/api/dados?after=${version}`, { cache: 'no-store' });
+            const etag = resp.headers.get('ETag');
+            const m = etag && etag.match(/"v(\d+)"/);
+            if (m) version = parseInt(m[1]);
+            if (resp.status === 200) {
+                const data = await resp.json();
+                if (!isPaused) updateDashboard(data);
+                setConnectionStatus(true);
+            } else if (resp.status === 304) {
+                setConnectionStatus(true);
+            } else {
+                // 503: todas as vagas de long-poll ocupadas
+                await new Promise(r => setTimeout(r, 2000));
+            }
+        } catch (e) {
+            setConnectionStatus(false);
+            await new Promise(r => setTimeout(r, 3000));
+        }
+    }
+}
+
 // --- Navegação (SPA) ---
 function navigate(pageId) {
     // Remove classe ativa de tudo
@@ -119,6 +194,11 @@ function initCharts() {
 // --- Core Loop de Dados ---
 function startDataLoop() {
     if (intervalId) clearInterval(intervalId);
+    // Feed ao vivo (ou long-poll) ativo dispensa o polling
+    if (longPollActive || (liveSocket && liveSocket.readyState === WebSocket.OPEN)) {
+        intervalId = null;
+        return;
+    }
     intervalId = setInterval(fetchData, updateInterval);
 }
 
@@ -139,13 +219,19 @@ async function fetchData() {
     if (isPaused) return;
 
     try {
-        // Faz a requisição ao ESP32
-        const response = await fetch('/api/dados');
-        
+        // Faz a requisição ao ESP32; 304 quando não chegou amostra nova
+        const headers = dataEtag ? { 'If-None-Match': dataEtag } : {};
+        const response = await fetch('/api/dados', { cache: 'no-store', headers });
+        if (response.status === 304) {
+            setConnectionStatus(true);
+            return;
+        }
+
         if (!response.ok) throw new Error("Falha na API");
-        
+
         const data = await response.json();
-        
+        dataEtag = response.headers.get('ETag');
+
         // Se chegou aqui, a conexão está OK
         setConnectionStatus(true);
         updateDashboard(data);
@@ -158,6 +244,52 @@ async function fetchData() {
     }
 }
 
+// --- Histórico (/api/history, binário) ---
+// Cabeçalho de 16 B (u8 versão, u8 nível, u16 n, u32 período, u32 agora,
+// u32 último balde; segundos de uptime) + n pontos de 4 B:
+// i16 temperatura em décimos de °C, u8 umidade, u8 chuva (ausente = -32768/255)
+async function loadHistory() {
+    const range = document.getElementById('history-range').value;
+    try {
+        const resp = await fetch(`/api/history?range=${range}`, { cache: 'no-store' });
+        if (!resp.ok) return; // ainda sem amostras
+        const view = new DataView(await resp.arrayBuffer());
+        if (view.byteLength < 16 || view.getUint8(0) !== 1) return;
+        const count = Math.min(view.getUint16(2, true), (view.byteLength - 16) / 4);
+        const period = view.getUint32(4, true);
+        const nowS = view.getUint32(8, true);
+        const lastS = view.getUint32(12, true);
+        const base = Date.now();
+
+        const labels = [], temp = [], hum = [], rain = [];
+        for (let i = 0; i < count; i++) {
+            const off = 16 + i * 4;
+            const t = view.getInt16(off, true);
+            const h = view.getUint8(off + 2);
+            const r = view.getUint8(off + 3);
+            const ts = lastS - (count - 1 - i) * period;
+            labels.push(new Date(base - (nowS - ts) * 1000).toLocaleTimeString());
+            temp.push(t === -32768 ? null : t / 10);
+            hum.push(h === 255 ? null : h);
+            rain.push(r === 255 ? null : r);
+        }
+
+        chartMaxPoints = Math.max(MAX_DATA_POINTS, count);
+        setChartSeries(charts.temp, labels, [temp]);
+        setChartSeries(charts.hum, labels, [hum]);
+        setChartSeries(charts.rain, labels, [rain]);
+        setChartSeries(charts.combo, labels, [temp, hum]);
+    } catch (error) {
+        console.warn("Histórico indisponível", error);
+    }
+}
+
+function setChartSeries(chart, labels, series) {
+    chart.data.labels = labels.slice();
+    series.forEach((data, i) => { chart.data.datasets[i].data = data.slice(); });
+    chart.update('none');
+}
+
 // --- Atualização da UI ---
 function updateDashboard(data) {
     const now = new Date().toLocaleTimeString();
@@ -175,7 +307,7 @@ function updateDashboard(data) {
     addDataToChart(charts.rain, now, data.rain);
     
     // Combo Chart
-    if (charts.combo.data.labels.length > MAX_DATA_POINTS) {
+    if (charts.combo.data.labels.length > chartMaxPoints) {
         charts.combo.data.labels.shift();
         charts.combo.data.datasets[0].data.shift();
         charts.combo.data.datasets[1].data.shift();
@@ -214,7 +346,7 @@ function updateCard(type, value, unit) {
 }
 
 function addDataToChart(chart, label, data) {
-    if (chart.data.labels.length > MAX_DATA_POINTS) {
+    if (chart.data.labels.length > chartMaxPoints) {
         chart.data.labels.shift();
         chart.data.datasets[0].data.shift();
     }
@@ -274,7 +406,11 @@ function saveConfig() {
         topic: document.getElementById('conf_topic').value,
         qos: document.getElementById('conf_qos').value,
         user: document.getElementById('conf_user').value,
-        pass_mqtt: document.getElementById('conf_pass_mqtt').value
+        pass_mqtt: document.getElementById('conf_pass_mqtt').value,
+        alert_temp_mid: document.getElementById('conf_alert_temp_mid').value,
+        alert_temp_high: document.getElementById('conf_alert_temp_high').value,
+        alert_rain_mid: document.getElementById('conf_alert_rain_mid').value,
+        alert_rain_heavy: document.getElementById('conf_alert_rain_heavy').value
     };
 
     // Envia para o ESP32
@@ -319,6 +455,9 @@ async function loadConfig() {
         if (cfg.qos !== undefined) document.getElementById('conf_qos').value = cfg.qos;
         if (cfg.user !== undefined) document.getElementById('conf_user').value = cfg.user || '';
         if (cfg.pass_mqtt !== undefined) document.getElementById('conf_pass_mqtt').value = cfg.pass_mqtt || '';
+        ['alert_temp_mid', 'alert_temp_high', 'alert_rain_mid', 'alert_rain_heavy'].forEach(k => {
+            if (cfg[k] !== undefined) document.getElementById('conf_' + k).value = cfg[k];
+        });
     } catch (e) {
         console.warn('Nao foi possivel carregar configuracoes:', e);
     }
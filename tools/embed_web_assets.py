@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""Compacta (gzip) os arquivos da pasta web/ e gera um .cpp com os bytes
+embutidos no firmware, ordenados por caminho para busca binária, ou
+(--image) uma imagem binária para a partição 'storage', mapeada em memória
+pelo firmware.
+
+Cada asset recebe um ETag forte derivado do conteúdo comprimido. As
+referências a CSS/JS dentro dos HTML são reescritas para "arquivo?v=<hash>",
+o que permite servi-los com Cache-Control imutável: uma nova versão muda a URL.
+
+Uso:
+    embed_web_assets.py --header web_assets.h --type web_asset_t -o saida.cpp web/*
+    embed_web_assets.py --image -o web_assets.bin web/*
+
+Formato da imagem (little-endian, offsets relativos ao início):
+    cabeçalho (16 B): magic "WAI1", u16 versão (1), u16 n, u32 tamanho total, u32 reservado
+    n entradas (32 B), ordenadas por caminho:
+        u32 path_off, u32 mime_off, u32 etag_off, u32 data_off, u32 data_len,
+        u32 flags (bit 0 = imutável), u32 reservado[2]
+    strings terminadas em '\\0' e blobs gzip (alinhados a 4 bytes)
+"""
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import struct
+import sys
+
+IMAGE_MAGIC = b"WAI1"
+IMAGE_VERSION = 1
+IMAGE_HEADER = struct.Struct("<4sHHII")
+IMAGE_ENTRY = struct.Struct("<IIIIII8x")
+
+MIME = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+    ".svg": "image/svg+xml",
+}
+
+
+def short_hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def build_image(assets):
+    n = len(assets)
+    table_end = IMAGE_HEADER.size + n * IMAGE_ENTRY.size
+    blob = bytearray()
+    entries = []
+
+    def put(data, align=1):
+        while (table_end + len(blob)) % align:
+            blob.append(0)
+        off = table_end + len(blob)
+        blob.extend(data)
+        return off
+
+    for p, mime, gz, etag, immutable, size in assets:
+        path_off = put(p.encode() + b"\0")
+        mime_off = put(mime.encode() + b"\0")
+        etag_off = put(etag.encode() + b"\0")
+        data_off = put(gz, 4)
+        entries.append(IMAGE_ENTRY.pack(path_off, mime_off, etag_off, data_off, len(gz), 1 if immutable else 0))
+
+    total = table_end + len(blob)
+    return IMAGE_HEADER.pack(IMAGE_MAGIC, IMAGE_VERSION, n, total, 0) + b"".join(entries) + bytes(blob)
+
+
+def write_if_changed(path, data):
+    # Só regrava se mudou, para não forçar recompilação
+    if os.path.exists(path):
+        with open(path, "rb") as f:
+            if f.read() == data:
+                return
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--header", help="header com a struct do asset")
+    ap.add_argument("--type", help="nome da struct do asset")
+    ap.add_argument("--image", action="store_true", help="gera a imagem binária da partição")
+    ap.add_argument("-o", "--output", required=True)
+    ap.add_argument("files", nargs="+")
+    args = ap.parse_args()
+    if not args.image and not (args.header and args.type):
+        ap.error("--header e --type são obrigatórios sem --image")
+
+    raw = {}
+    for path in args.files:
+        if os.path.isfile(path):
+            with open(path, "rb") as f:
+                raw["/" + os.path.basename(path)] = f.read()
+
+    # Versão de cada asset não-HTML, usada para reescrever as referências
+    versions = {p: short_hash(d) for p, d in raw.items() if not p.endswith(".html")}
+
+    def rewrite(html):
+        text = html.decode("utf-8")
+        for p, v in versions.items():
+            name = re.escape(p[1:])
+            text = re.sub(r'((?:src|href)=")(%s)(")' % name, r"\g<1>\g<2>?v=%s\g<3>" % v, text)
+        return text.encode("utf-8")
+
+    assets = []
+    for p in sorted(raw):
+        data = rewrite(raw[p]) if p.endswith(".html") else raw[p]
+        gz = gzip.compress(data, compresslevel=9, mtime=0)
+        mime = MIME.get(os.path.splitext(p)[1], "application/octet-stream")
+        assets.append((p, mime, gz, '"%s"' % short_hash(gz), not p.endswith(".html"), len(data)))
+
+    if args.image:
+        write_if_changed(args.output, build_image(assets))
+        return 0
+
+    out = []
+    out.append("// Gerado por tools/embed_web_assets.py - nao editar")
+    out.append('#include "%s"' % args.header)
+    out.append("")
+    for i, (p, mime, gz, etag, immutable, size) in enumerate(assets):
+        out.append("// %s: %d -> %d bytes (gzip)" % (p, size, len(gz)))
+        out.append("static const uint8_t s_asset_%d[] = {" % i)
+        out.append(c_bytes(gz))
+        out.append("};")
+        out.append("")
+    out.append("const %s g_web_assets[] = {" % args.type)
+    for i, (p, mime, gz, etag, immutable, size) in enumerate(assets):
+        out.append('    {"%s", "%s", s_asset_%d, sizeof(s_asset_%d), "%s", %s},'
+                   % (p, mime, i, i, etag.replace('"', '\\"'), "true" if immutable else "false"))
+    out.append("};")
+    out.append("")
+    out.append("const size_t g_web_assets_count = %d;" % len(assets))
+    out.append("")
+
+    write_if_changed(args.output, "\n".join(out).encode("utf-8"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())